@@ -0,0 +1,46 @@
+#ifndef _LED_ATOMIC_H_
+#define _LED_ATOMIC_H_
+
+// Thin wrappers over the GCC/Clang atomic builtins, or C11 <stdatomic.h>
+// elsewhere, so that public headers can keep plain integer types and stay
+// usable from C++ test code.
+#if defined(__GNUC__) || defined(__clang__)
+
+#define LED_ATOMIC_LOAD(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define LED_ATOMIC_LOAD_RELAXED(ptr) __atomic_load_n((ptr), __ATOMIC_RELAXED)
+#define LED_ATOMIC_STORE(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+#define LED_ATOMIC_STORE_RELAXED(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELAXED)
+#define LED_ATOMIC_EXCHANGE(ptr, value) __atomic_exchange_n((ptr), (value), __ATOMIC_ACQ_REL)
+#define LED_ATOMIC_FETCH_ADD(ptr, value) __atomic_fetch_add((ptr), (value), __ATOMIC_ACQ_REL)
+#define LED_ATOMIC_FETCH_SUB(ptr, value) __atomic_fetch_sub((ptr), (value), __ATOMIC_ACQ_REL)
+#define LED_ATOMIC_FENCE() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define LED_ATOMIC_FENCE_ACQUIRE() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define LED_ATOMIC_FENCE_RELEASE() __atomic_thread_fence(__ATOMIC_RELEASE)
+#define LED_ATOMIC_CAS(ptr, expected, desired) \
+    __atomic_compare_exchange_n((ptr), (expected), (desired), false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+
+#elif !defined(__cplusplus) && defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && !defined(__STDC_NO_ATOMICS__)
+
+// Any other C11 compiler. The shared fields are plain integers and pointers,
+// which relies on them having the size and representation of their _Atomic
+// counterparts, as they do on every lock-free target.
+#include "stdatomic.h"
+
+#define LED_ATOMIC_LOAD(ptr) atomic_load_explicit((ptr), memory_order_acquire)
+#define LED_ATOMIC_LOAD_RELAXED(ptr) atomic_load_explicit((ptr), memory_order_relaxed)
+#define LED_ATOMIC_STORE(ptr, value) atomic_store_explicit((ptr), (value), memory_order_release)
+#define LED_ATOMIC_STORE_RELAXED(ptr, value) atomic_store_explicit((ptr), (value), memory_order_relaxed)
+#define LED_ATOMIC_EXCHANGE(ptr, value) atomic_exchange_explicit((ptr), (value), memory_order_acq_rel)
+#define LED_ATOMIC_FETCH_ADD(ptr, value) atomic_fetch_add_explicit((ptr), (value), memory_order_acq_rel)
+#define LED_ATOMIC_FETCH_SUB(ptr, value) atomic_fetch_sub_explicit((ptr), (value), memory_order_acq_rel)
+#define LED_ATOMIC_FENCE() atomic_thread_fence(memory_order_seq_cst)
+#define LED_ATOMIC_FENCE_ACQUIRE() atomic_thread_fence(memory_order_acquire)
+#define LED_ATOMIC_FENCE_RELEASE() atomic_thread_fence(memory_order_release)
+#define LED_ATOMIC_CAS(ptr, expected, desired) \
+    atomic_compare_exchange_strong_explicit((ptr), (expected), (desired), memory_order_acq_rel, memory_order_acquire)
+
+#else
+#error "LedAtomic.h: needs GCC/Clang atomic builtins or C11 <stdatomic.h>"
+#endif
+
+#endif
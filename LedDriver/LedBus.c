@@ -0,0 +1,267 @@
+#include "LedBus.h"
+#include "LedAtomic.h"
+#include "stddef.h"
+#include "time.h"
+
+#define TRUE 1
+#define FALSE 0
+
+#define DEFAULT_FRAME_BYTES 2
+#define NS_PER_SECOND 1000000000ULL
+
+// Selection is process-wide so that writes from worker threads, such as
+// LedFleet's, reach the bus too
+static LedBus* selectedBus;
+
+static uint64_t transferTime(const LedBus* Bus, uint64_t Bytes);
+static uint32_t drawJitter(LedBus* Bus);
+
+int LedBus_Init(LedBus* Bus, const LedBus_Config* Config, uint16_t* Registers, uint32_t Count)
+{
+    int result;
+
+    result = -1;
+
+    if ((NULL != Bus) && (NULL != Config) && (NULL != Registers) && (0 < Count))
+    {
+        Bus->config = *Config;
+        Bus->registers = Registers;
+        Bus->count = Count;
+
+        if (0 == Bus->config.frame_bytes)
+        {
+            Bus->config.frame_bytes = DEFAULT_FRAME_BYTES;
+        }
+
+        Bus->now = 0;
+        Bus->free_at = 0;
+        Bus->lock = FALSE;
+        Bus->rng = (0 == Config->seed) ? 1 : Config->seed;
+
+        LedBus_ResetStats(Bus);
+
+        result = 0;
+    }
+
+    return result;
+}
+
+bool LedBus_Owns(const LedBus* Bus, const uint16_t* Address)
+{
+    return ((NULL != Bus) && (Address >= Bus->registers) && (Address < (Bus->registers + Bus->count)));
+}
+
+void LedBus_SetTime(LedBus* Bus, uint64_t Now)
+{
+    if (NULL != Bus)
+    {
+        Bus->now = Now;
+    }
+}
+
+uint64_t LedBus_Write(LedBus* Bus, uint16_t* Address, uint16_t Value)
+{
+    return LedBus_WriteBurst(Bus, Address, &Value, 1);
+}
+
+uint64_t LedBus_WriteBurst(LedBus* Bus, uint16_t* Address, const uint16_t* Values, uint32_t Count)
+{
+    uint64_t done;
+    uint64_t now;
+    uint64_t start;
+    uint64_t bytes;
+    uint64_t cost;
+    bool unchanged;
+    uint32_t i;
+
+    done = 0;
+
+    if ((NULL != Bus) && (NULL != Address) && (NULL != Values) && (0 < Count))
+    {
+        // Writers on several threads take the bus in turn
+        while (FALSE != LED_ATOMIC_EXCHANGE(&Bus->lock, TRUE))
+        {
+        }
+
+        if (TRUE == Bus->config.real_time)
+        {
+            now = LedBus_Now();
+        }
+        else
+        {
+            now = Bus->now;
+        }
+
+        start = now;
+
+        if (Bus->free_at > now)
+        {
+            start = Bus->free_at;
+            Bus->stats.queued_ns += start - now;
+        }
+
+        // One frame addresses the first register, the rest follow as data only
+        bytes = Bus->config.frame_bytes + ((uint64_t)(Count - 1) * sizeof(uint16_t));
+        cost = Bus->config.latency_ns + transferTime(Bus, bytes) + drawJitter(Bus);
+
+        unchanged = TRUE;
+
+        for (i = 0; i < Count; i++)
+        {
+            if (Address[i] != Values[i])
+            {
+                unchanged = FALSE;
+            }
+        }
+
+        if (TRUE == unchanged)
+        {
+            Bus->stats.redundant++;
+        }
+
+        Bus->free_at = start + cost;
+        Bus->stats.writes++;
+        Bus->stats.bytes += bytes;
+        Bus->stats.busy_ns += cost;
+
+        if (cost > Bus->stats.max_write_ns)
+        {
+            Bus->stats.max_write_ns = (uint32_t)cost;
+        }
+
+        done = Bus->free_at;
+
+        // Stored while the bus is held, so registers change in the order the
+        // transfers were booked and the redundancy check above sees every
+        // earlier write; only the wait for the transfer is left outside
+        for (i = 0; i < Count; i++)
+        {
+            Address[i] = Values[i];
+        }
+
+        LED_ATOMIC_STORE(&Bus->lock, FALSE);
+
+        if (TRUE == Bus->config.real_time)
+        {
+            // A polled bus: the caller holds the CPU until the transfer is done
+            while (LedBus_Now() < done)
+            {
+            }
+        }
+    }
+
+    return done;
+}
+
+void LedBus_GetStats(const LedBus* Bus, LedBus_Stats* Stats)
+{
+    if ((NULL != Bus) && (NULL != Stats))
+    {
+        *Stats = Bus->stats;
+    }
+}
+
+void LedBus_ResetStats(LedBus* Bus)
+{
+    if (NULL != Bus)
+    {
+        Bus->stats.writes = 0;
+        Bus->stats.redundant = 0;
+        Bus->stats.bytes = 0;
+        Bus->stats.busy_ns = 0;
+        Bus->stats.queued_ns = 0;
+        Bus->stats.max_write_ns = 0;
+    }
+}
+
+void LedBus_Select(LedBus* Bus)
+{
+    LED_ATOMIC_STORE(&selectedBus, Bus);
+}
+
+LedBus* LedBus_Selected(void)
+{
+    return LED_ATOMIC_LOAD(&selectedBus);
+}
+
+void LedBus_Store(uint16_t* Address, uint16_t Value)
+{
+    LedBus* bus;
+
+    bus = LedBus_Selected();
+
+    if (TRUE == LedBus_Owns(bus, Address))
+    {
+        (void)LedBus_Write(bus, Address, Value);
+    }
+    else
+    {
+        *Address = Value;
+    }
+}
+
+void LedBus_StoreBurst(uint16_t* Address, const uint16_t* Values, uint32_t Count)
+{
+    LedBus* bus;
+    uint32_t i;
+
+    bus = LedBus_Selected();
+
+    if ((0 < Count) && (TRUE == LedBus_Owns(bus, Address)) && (TRUE == LedBus_Owns(bus, &Address[Count - 1])))
+    {
+        (void)LedBus_WriteBurst(bus, Address, Values, Count);
+    }
+    else
+    {
+        for (i = 0; i < Count; i++)
+        {
+            Address[i] = Values[i];
+        }
+    }
+}
+
+uint64_t LedBus_Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * NS_PER_SECOND) + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t transferTime(const LedBus* Bus, uint64_t Bytes)
+{
+    uint64_t result;
+
+    result = 0;
+
+    // Rounded up: a limit of 1 MB/s must never pass more than 1 MB/s
+    if (0 != Bus->config.bytes_per_second)
+    {
+        result = ((Bytes * NS_PER_SECOND) + Bus->config.bytes_per_second - 1) / Bus->config.bytes_per_second;
+    }
+
+    return result;
+}
+
+static uint32_t drawJitter(LedBus* Bus)
+{
+    uint64_t x;
+    uint32_t result;
+
+    result = 0;
+
+    if (0 != Bus->config.jitter_ns)
+    {
+        // xorshift64*, so a seed gives the same jitter on every host
+        x = Bus->rng;
+        x ^= x >> 12;
+        x ^= x << 25;
+        x ^= x >> 27;
+        Bus->rng = x;
+
+        result = (uint32_t)(((x * 0x2545F4914F6CDD1DULL) >> 32) % ((uint64_t)Bus->config.jitter_ns + 1));
+    }
+
+    return result;
+}
@@ -0,0 +1,96 @@
+#ifndef _LED_BUS_H_
+#define _LED_BUS_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+
+// Catch2 is a C++ test framework, to link a C library you need these tags
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    uint32_t latency_ns;        // fixed cost of every write (addressing, chip select)
+    uint32_t bytes_per_second;  // 0 for no bandwidth limit
+    uint32_t frame_bytes;       // bytes sent per register write, 0 for 2
+    uint32_t jitter_ns;         // extra cost drawn uniformly from 0..jitter_ns
+    uint64_t seed;              // jitter generator seed
+    bool real_time;             // block callers for the cost of each write
+} LedBus_Config;
+
+typedef struct
+{
+    uint64_t writes;            // transactions, a burst counts once
+    uint64_t redundant;         // writes that changed no register
+    uint64_t bytes;
+    uint64_t busy_ns;           // time the bus spent transferring
+    uint64_t queued_ns;         // time writes waited for the previous one
+    uint32_t max_write_ns;
+} LedBus_Stats;
+
+// Emulates a slow register bus such as SPI or I2C carrying the registers
+// Registers[0..Count-1], which the caller provides. A write occupies the bus
+// for latency + frame_bytes / bytes_per_second + jitter, and a write issued
+// while the bus is busy waits for it first. Time is either the monotonic
+// clock (real_time) or a virtual clock the caller moves with SetTime, so the
+// same model serves wall-clock benchmarks and deterministic simulation.
+// Writers on several threads take the bus in turn, as they would share a
+// real one.
+typedef struct
+{
+    LedBus_Config config;
+    uint16_t* registers;
+    uint32_t count;
+    uint64_t now;
+    uint64_t free_at;
+    uint64_t rng;
+    uint32_t lock;
+    LedBus_Stats stats;
+} LedBus;
+
+int LedBus_Init(LedBus* Bus, const LedBus_Config* Config, uint16_t* Registers, uint32_t Count);
+
+// True if Address is one of the bus registers
+bool LedBus_Owns(const LedBus* Bus, const uint16_t* Address);
+
+// Sets the virtual clock; ignored in real time
+void LedBus_SetTime(LedBus* Bus, uint64_t Now);
+
+// Stores Value at Address through the bus and returns the time the write
+// completes. In real time this returns only once that time has passed.
+uint64_t LedBus_Write(LedBus* Bus, uint16_t* Address, uint16_t Value);
+
+// Writes Count consecutive registers from Address in one transaction: one
+// latency and frame, then two more bytes per extra register. Returns 0 and
+// writes nothing for a NULL argument or a Count of 0.
+uint64_t LedBus_WriteBurst(LedBus* Bus, uint16_t* Address, const uint16_t* Values, uint32_t Count);
+
+void LedBus_GetStats(const LedBus* Bus, LedBus_Stats* Stats);
+
+void LedBus_ResetStats(LedBus* Bus);
+
+// Routes driver writes to registers of Bus through the bus; writes
+// elsewhere, such as a rate limiter's staging word, stay plain stores. NULL
+// deselects. The selection is process-wide rather than per thread, so
+// writes from worker threads, such as LedFleet's, are routed too. Only
+// drivers built with LED_DRIVER_BUS (LedDriver::bus) send their writes here.
+void LedBus_Select(LedBus* Bus);
+
+LedBus* LedBus_Selected(void);
+
+// Register store used by LED_DRIVER_BUS builds, through the selected bus if
+// it owns Address
+void LedBus_Store(uint16_t* Address, uint16_t Value);
+
+void LedBus_StoreBurst(uint16_t* Address, const uint16_t* Values, uint32_t Count);
+
+// Monotonic clock in nanoseconds
+uint64_t LedBus_Now(void);
+
+// Catch2 is a C++ test framework, to link a C library you need these tags
+#ifdef __cplusplus
+}
+#endif
+
+#endif
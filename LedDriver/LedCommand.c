@@ -0,0 +1,302 @@
+#include "LedCommand.h"
+#include "RuntimeError.h"
+
+#define MIN_LED 1
+#define MAX_LED 16
+#define TRUE 1
+#define FALSE 0
+
+// Larger numbers are clamped; they are out of range either way
+#define MAX_NUMBER 99999
+
+typedef struct
+{
+    const char* next;
+    const char* end;
+} Cursor;
+
+static void skipSpaces(Cursor* Text);
+static bool atEndOfBatch(const Cursor* Text);
+static bool acceptWord(Cursor* Text, const char* Word);
+static bool acceptChar(Cursor* Text, char Expected);
+static bool parseNumber(Cursor* Text, int* Number);
+static bool parseList(Cursor* Text, LedCommand_Batch* Batch, uint16_t* Mask);
+static uint16_t rangeMask(int First, int Last, LedCommand_Batch* Batch);
+
+int LedCommand_Parse(const char* Text, size_t Length, LedCommand_Batch* Batch, size_t* Consumed)
+{
+    int result;
+    Cursor text;
+    uint16_t mask;
+    bool ok;
+
+    result = -1;
+
+    if ((NULL != Text) && (NULL != Batch))
+    {
+        text.next = Text;
+        text.end = Text + Length;
+
+        Batch->turn_on = 0;
+        Batch->turn_off = 0;
+        Batch->out_of_range = 0;
+        Batch->first_out_of_range = 0;
+
+        ok = TRUE;
+
+        while ((TRUE == ok) && (FALSE == atEndOfBatch(&text)))
+        {
+            skipSpaces(&text);
+
+            if (TRUE == acceptWord(&text, "all"))
+            {
+                skipSpaces(&text);
+
+                if (TRUE == acceptWord(&text, "on"))
+                {
+                    Batch->turn_on = 0xFFFF;
+                    Batch->turn_off = 0;
+                }
+                else if (TRUE == acceptWord(&text, "off"))
+                {
+                    Batch->turn_on = 0;
+                    Batch->turn_off = 0xFFFF;
+                }
+                else
+                {
+                    ok = FALSE;
+                }
+            }
+            else if (TRUE == acceptWord(&text, "on"))
+            {
+                ok = parseList(&text, Batch, &mask);
+                Batch->turn_on |= mask;
+                Batch->turn_off &= ~mask;
+            }
+            else if (TRUE == acceptWord(&text, "off"))
+            {
+                ok = parseList(&text, Batch, &mask);
+                Batch->turn_off |= mask;
+                Batch->turn_on &= ~mask;
+            }
+
+            // Empty commands (";;" or a trailing ';') are allowed
+            skipSpaces(&text);
+
+            if ((TRUE == ok) && (FALSE == atEndOfBatch(&text)) && (FALSE == acceptChar(&text, ';')))
+            {
+                ok = FALSE;
+            }
+        }
+
+        // Skip the rest of a bad line so the next one parses
+        while (FALSE == atEndOfBatch(&text))
+        {
+            text.next++;
+        }
+
+        if ((text.next < text.end) && ('\n' == *text.next))
+        {
+            text.next++;
+        }
+
+        if (NULL != Consumed)
+        {
+            *Consumed = (size_t)(text.next - Text);
+        }
+
+        if (TRUE == ok)
+        {
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+int LedCommand_Apply(LedDriver_Bank* Bank, const LedCommand_Batch* Batch)
+{
+    int result;
+
+    result = -1;
+
+    if (NULL != Batch)
+    {
+        result = 0;
+
+        if ((0 != Batch->turn_on) || (0 != Batch->turn_off))
+        {
+            result = LedDriver_BankUpdate(Bank, Batch->turn_on, Batch->turn_off);
+        }
+
+        if (0 != Batch->out_of_range)
+        {
+            RUNTIME_ERROR("LED Command: out-of-bounds LED", Batch->first_out_of_range);
+            result = -1;
+        }
+    }
+
+    return result;
+}
+
+int LedCommand_Run(LedDriver_Bank* Bank, const char* Text, size_t Length)
+{
+    int failed;
+    LedCommand_Batch batch;
+    size_t consumed;
+
+    failed = 0;
+
+    if (NULL != Text)
+    {
+        while ((0 < Length) && ('\0' != *Text))
+        {
+            if ((0 != LedCommand_Parse(Text, Length, &batch, &consumed)) || (0 != LedCommand_Apply(Bank, &batch)))
+            {
+                failed++;
+            }
+
+            Text += consumed;
+            Length -= consumed;
+        }
+    }
+
+    return failed;
+}
+
+static void skipSpaces(Cursor* Text)
+{
+    while ((Text->next < Text->end) && ((' ' == *Text->next) || ('\t' == *Text->next) || ('\r' == *Text->next)))
+    {
+        Text->next++;
+    }
+}
+
+static bool atEndOfBatch(const Cursor* Text)
+{
+    return ((Text->next >= Text->end) || ('\n' == *Text->next) || ('\0' == *Text->next));
+}
+
+// Matches Word when it is not followed by more letters
+static bool acceptWord(Cursor* Text, const char* Word)
+{
+    bool accepted;
+    const char* next;
+
+    accepted = FALSE;
+    next = Text->next;
+
+    while (('\0' != *Word) && (next < Text->end) && (*Word == *next))
+    {
+        Word++;
+        next++;
+    }
+
+    if (('\0' == *Word) && ((next >= Text->end) || (*next < 'a') || (*next > 'z')))
+    {
+        Text->next = next;
+        accepted = TRUE;
+    }
+
+    return accepted;
+}
+
+static bool acceptChar(Cursor* Text, char Expected)
+{
+    bool accepted;
+
+    accepted = FALSE;
+
+    if ((Text->next < Text->end) && (Expected == *Text->next))
+    {
+        Text->next++;
+        accepted = TRUE;
+    }
+
+    return accepted;
+}
+
+static bool parseNumber(Cursor* Text, int* Number)
+{
+    const char* start;
+
+    skipSpaces(Text);
+
+    start = Text->next;
+    *Number = 0;
+
+    while ((Text->next < Text->end) && (*Text->next >= '0') && (*Text->next <= '9'))
+    {
+        if (MAX_NUMBER > *Number)
+        {
+            *Number = (*Number * 10) + (*Text->next - '0');
+        }
+
+        Text->next++;
+    }
+
+    return (start != Text->next);
+}
+
+static bool parseList(Cursor* Text, LedCommand_Batch* Batch, uint16_t* Mask)
+{
+    bool ok;
+    int first;
+    int last;
+
+    *Mask = 0;
+
+    do
+    {
+        ok = parseNumber(Text, &first);
+        last = first;
+
+        skipSpaces(Text);
+
+        if ((TRUE == ok) && (TRUE == acceptChar(Text, '-')))
+        {
+            ok = (parseNumber(Text, &last) && (first <= last));
+            skipSpaces(Text);
+        }
+
+        if (TRUE == ok)
+        {
+            *Mask |= rangeMask(first, last, Batch);
+        }
+    } while ((TRUE == ok) && (TRUE == acceptChar(Text, ',')));
+
+    return ok;
+}
+
+// LEDs First..Last as a mask, counting the ones outside MIN_LED..MAX_LED
+static uint16_t rangeMask(int First, int Last, LedCommand_Batch* Batch)
+{
+    uint16_t mask;
+    int low;
+    int high;
+    int valid;
+
+    mask = 0;
+    valid = 0;
+
+    low = (MIN_LED > First) ? MIN_LED : First;
+    high = (MAX_LED < Last) ? MAX_LED : Last;
+
+    if (low <= high)
+    {
+        valid = (high - low) + 1;
+        mask = (uint16_t)((0xFFFFu >> (MAX_LED - valid)) << (low - MIN_LED));
+    }
+
+    if (valid != ((Last - First) + 1))
+    {
+        if (0 == Batch->out_of_range)
+        {
+            Batch->first_out_of_range = ((low != First) || (low > high)) ? First : (high + 1);
+        }
+
+        Batch->out_of_range += (uint32_t)(((Last - First) + 1) - valid);
+    }
+
+    return mask;
+}
@@ -0,0 +1,51 @@
+#ifndef _LED_COMMAND_H_
+#define _LED_COMMAND_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "stddef.h"
+#include "LedDriver.h"
+
+// Catch2 is a C++ test framework, to link a C library you need these tags
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Text front end for scripts and operator consoles. A batch is one line of
+// commands separated by ';':
+//
+//     on 1-8,12; off 3; all off
+//
+// "on" and "off" take a list of LED numbers and ranges, "all on" and
+// "all off" take nothing. Commands apply left to right, so a later command
+// wins over an earlier one for the same LED.
+
+// A parsed batch: bit n-1 of a mask is LED n
+typedef struct
+{
+    uint16_t turn_on;
+    uint16_t turn_off;
+    uint32_t out_of_range;
+    int first_out_of_range;
+} LedCommand_Batch;
+
+// Parses the batch at the start of Text, up to a newline, NUL or Length
+// characters. Consumed (if not NULL) is set to the number of characters used,
+// including the newline. Returns -1 on a syntax error; out-of-range LEDs are
+// counted and left out of the masks.
+int LedCommand_Parse(const char* Text, size_t Length, LedCommand_Batch* Batch, size_t* Consumed);
+
+// Applies a parsed batch with one masked update, reporting out-of-range LEDs
+// through RUNTIME_ERROR once. Returns -1 if any LED was out of range.
+int LedCommand_Apply(LedDriver_Bank* Bank, const LedCommand_Batch* Batch);
+
+// Parses and applies every line of Text. Lines with syntax errors are not
+// applied. Returns the number of lines that failed to parse or apply.
+int LedCommand_Run(LedDriver_Bank* Bank, const char* Text, size_t Length);
+
+// Catch2 is a C++ test framework, to link a C library you need these tags
+#ifdef __cplusplus
+}
+#endif
+
+#endif
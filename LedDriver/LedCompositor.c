@@ -0,0 +1,195 @@
+#include "LedCompositor.h"
+#include "stddef.h"
+
+#define TRUE 1
+#define FALSE 0
+
+// No layer changed since the last flush
+#define CLEAN LED_COMPOSITOR_MAX_LAYERS
+
+static bool isValidLayer(const LedCompositor* Compositor, int Layer);
+static void markDirty(LedCompositor* Compositor, int Layer);
+
+int LedCompositor_Init(LedCompositor* Compositor, LedDriver_Bank* Bank)
+{
+    int result;
+
+    result = -1;
+
+    if ((NULL != Compositor) && (NULL != Bank))
+    {
+        Compositor->bank = Bank;
+        Compositor->layers = 0;
+        Compositor->dirty_rank = CLEAN;
+        Compositor->written = FALSE;
+        Compositor->output = 0;
+        Compositor->above_value[0] = 0;
+        Compositor->above_owned[0] = 0;
+
+        result = 0;
+    }
+
+    return result;
+}
+
+int LedCompositor_AddLayer(LedCompositor* Compositor, uint8_t Priority)
+{
+    int result;
+    uint8_t id;
+    uint8_t position;
+    uint8_t i;
+
+    result = -1;
+
+    if ((NULL != Compositor) && (LED_COMPOSITOR_MAX_LAYERS > Compositor->layers))
+    {
+        id = Compositor->layers;
+
+        Compositor->layer[id].value = 0;
+        Compositor->layer[id].owned = 0;
+        Compositor->layer[id].priority = Priority;
+
+        // Insert after every layer of equal or higher priority
+        position = 0;
+
+        while ((position < id) && (Compositor->layer[Compositor->order[position]].priority >= Priority))
+        {
+            position++;
+        }
+
+        for (i = id; i > position; i--)
+        {
+            Compositor->order[i] = Compositor->order[i - 1];
+            Compositor->rank[Compositor->order[i]] = i;
+        }
+
+        Compositor->order[position] = id;
+        Compositor->rank[id] = position;
+        Compositor->layers++;
+
+        // The cached composite below the new layer is stale
+        if (position < Compositor->dirty_rank)
+        {
+            Compositor->dirty_rank = position;
+        }
+
+        result = id;
+    }
+
+    return result;
+}
+
+int LedCompositor_Set(LedCompositor* Compositor, int Layer, uint16_t LedMask, bool On)
+{
+    int result;
+    LedCompositor_Layer* layer;
+
+    result = -1;
+
+    if (TRUE == isValidLayer(Compositor, Layer))
+    {
+        layer = &Compositor->layer[Layer];
+
+        layer->owned |= LedMask;
+
+        if (TRUE == On)
+        {
+            layer->value |= LedMask;
+        }
+        else
+        {
+            layer->value &= ~LedMask;
+        }
+
+        markDirty(Compositor, Layer);
+
+        result = 0;
+    }
+
+    return result;
+}
+
+int LedCompositor_Release(LedCompositor* Compositor, int Layer, uint16_t LedMask)
+{
+    int result;
+    LedCompositor_Layer* layer;
+
+    result = -1;
+
+    if (TRUE == isValidLayer(Compositor, Layer))
+    {
+        layer = &Compositor->layer[Layer];
+
+        layer->owned &= ~LedMask;
+        layer->value &= ~LedMask;
+
+        markDirty(Compositor, Layer);
+
+        result = 0;
+    }
+
+    return result;
+}
+
+int LedCompositor_Flush(LedCompositor* Compositor)
+{
+    int result;
+    const LedCompositor_Layer* layer;
+    uint16_t value;
+    uint16_t owned;
+    uint8_t rank;
+
+    result = -1;
+
+    if (NULL != Compositor)
+    {
+        result = 0;
+
+        if (CLEAN != Compositor->dirty_rank)
+        {
+            value = Compositor->above_value[Compositor->dirty_rank];
+            owned = Compositor->above_owned[Compositor->dirty_rank];
+
+            for (rank = Compositor->dirty_rank; rank < Compositor->layers; rank++)
+            {
+                layer = &Compositor->layer[Compositor->order[rank]];
+
+                value |= layer->value & ~owned;
+                owned |= layer->owned;
+
+                Compositor->above_value[rank + 1] = value;
+                Compositor->above_owned[rank + 1] = owned;
+            }
+
+            Compositor->dirty_rank = CLEAN;
+        }
+
+        value = Compositor->above_value[Compositor->layers];
+
+        if ((FALSE == Compositor->written) || (value != Compositor->output))
+        {
+            result = LedDriver_BankUpdate(Compositor->bank, value, (uint16_t)~value);
+
+            if (0 == result)
+            {
+                Compositor->output = value;
+                Compositor->written = TRUE;
+            }
+        }
+    }
+
+    return result;
+}
+
+static bool isValidLayer(const LedCompositor* Compositor, int Layer)
+{
+    return ((NULL != Compositor) && (0 <= Layer) && (Compositor->layers > Layer));
+}
+
+static void markDirty(LedCompositor* Compositor, int Layer)
+{
+    if (Compositor->rank[Layer] < Compositor->dirty_rank)
+    {
+        Compositor->dirty_rank = Compositor->rank[Layer];
+    }
+}
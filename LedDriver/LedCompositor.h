@@ -0,0 +1,64 @@
+#ifndef _LED_COMPOSITOR_H_
+#define _LED_COMPOSITOR_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "LedDriver.h"
+
+// Catch2 is a C++ test framework, to link a C library you need these tags
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef LED_COMPOSITOR_MAX_LAYERS
+#define LED_COMPOSITOR_MAX_LAYERS 8
+#endif
+
+// What one producer wants: the LEDs it owns and their state. Bit n-1 is LED n.
+typedef struct
+{
+    uint16_t value;
+    uint16_t owned;
+    uint8_t priority;
+} LedCompositor_Layer;
+
+// Several producers sharing one bank. For each LED the highest priority layer
+// that owns it decides its state; LEDs nobody owns are off. Layers are kept in
+// priority order with the composite of all layers above each one cached, so a
+// flush only recomputes from the highest priority layer dirtied since the last
+// flush, however often that layer was changed.
+typedef struct
+{
+    LedDriver_Bank* bank;
+    uint8_t layers;
+    uint8_t dirty_rank;
+    bool written;
+    uint16_t output;
+    LedCompositor_Layer layer[LED_COMPOSITOR_MAX_LAYERS];
+    uint8_t order[LED_COMPOSITOR_MAX_LAYERS];
+    uint8_t rank[LED_COMPOSITOR_MAX_LAYERS];
+    uint16_t above_value[LED_COMPOSITOR_MAX_LAYERS + 1];
+    uint16_t above_owned[LED_COMPOSITOR_MAX_LAYERS + 1];
+} LedCompositor;
+
+int LedCompositor_Init(LedCompositor* Compositor, LedDriver_Bank* Bank);
+
+// Returns the new layer's id, or -1 when all layers are taken. Among equal
+// priorities the layer added first wins.
+int LedCompositor_AddLayer(LedCompositor* Compositor, uint8_t Priority);
+
+// Takes ownership of the LEDs in LedMask and turns them on or off
+int LedCompositor_Set(LedCompositor* Compositor, int Layer, uint16_t LedMask, bool On);
+
+// Gives up the LEDs in LedMask so lower priority layers show through
+int LedCompositor_Release(LedCompositor* Compositor, int Layer, uint16_t LedMask);
+
+// Writes the composite to the bank if it changed since the last flush
+int LedCompositor_Flush(LedCompositor* Compositor);
+
+// Catch2 is a C++ test framework, to link a C library you need these tags
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -13,19 +13,123 @@ extern "C" {
 
 #include "stdint.h"
 
-int LedDriver_Init(uint16_t* Address, bool InvertOutput, bool InvertInput);
+// Defining LED_DRIVER_INLINE before including this header (or linking the
+// LedDriver::inline target) turns the whole API into static inline functions
+// so calls compile into the caller's loops. Only the storage of the default
+// bank stays in the library.
+#ifdef LED_DRIVER_INLINE
+#define LED_DRIVER_API static inline
+#else
+#define LED_DRIVER_API
+#endif
+
+// Register bit for each logical LED: bits[n-1] is the single bit driving LED n
+typedef struct
+{
+    uint16_t bits[16];
+} LedDriver_Map;
+
+// Wear counters, see LedWear.h
+struct LedWear_Counters;
+
+// Write rate limiter, see LedRateLimit.h
+struct LedRateLimit;
+
+// One LED register and its shadow copy. Callers own the storage so that any
+// number of registers can be driven side by side. Writes to a bank must come
+// from one thread at a time; any number of threads may read it alongside.
+// sequence is odd while (re-)initialisation or a redirect is changing the
+// address, map, polarity and register copy together, so readers can tell a
+// consistent view. wear, when attached, is told about every register write,
+// see LedWear.h. limit is the rate limiter that owns the staging word the
+// bank writes to instead of its register, and counts those writes.
+typedef struct
+{
+    uint16_t* address;
+    const LedDriver_Map* map;
+    struct LedWear_Counters* wear;
+    struct LedRateLimit* limit;
+    uint32_t sequence;
+    uint16_t status;
+    bool inverted_output;
+    bool inverted_input;
+} LedDriver_Bank;
+
+LED_DRIVER_API int LedDriver_Init(uint16_t* Address, bool InvertOutput, bool InvertInput);
+
+// As LedDriver_Init, but takes over a known register image (for example one
+// restored from a snapshot) instead of switching every LED off first
+LED_DRIVER_API int LedDriver_Adopt(uint16_t* Address, bool InvertOutput, bool InvertInput, uint16_t Status);
+
+LED_DRIVER_API int LedDriver_TurnOn(int16_t LedIndex);
+
+LED_DRIVER_API int LedDriver_TurnOff(int16_t LedIndex);
+
+LED_DRIVER_API int LedDriver_TurnOnAll(void);
+
+LED_DRIVER_API int LedDriver_TurnOffAll(void);
+
+LED_DRIVER_API bool LedDriver_IsOn(int16_t LedIndex);
+
+LED_DRIVER_API bool LedDriver_IsOff(int16_t LedIndex);
 
-int LedDriver_TurnOn(int16_t LedIndex);
+// The bank behind the calls above, for code that works on banks
+LED_DRIVER_API LedDriver_Bank* LedDriver_GetDefaultBank(void);
 
-int LedDriver_TurnOff(int16_t LedIndex);
+// Same operations as above, applied to an explicit bank
+LED_DRIVER_API int LedDriver_BankInit(LedDriver_Bank* Bank, uint16_t* Address, bool InvertOutput, bool InvertInput);
 
-int LedDriver_TurnOnAll(void);
+// Builds a map from the register bit position (0-15) of each LED, where
+// PhysicalBits[n-1] belongs to LED n. Every bit must be used exactly once.
+LED_DRIVER_API int LedDriver_MapInit(LedDriver_Map* Map, const uint8_t* PhysicalBits);
 
-int LedDriver_TurnOffAll(void);
+// As LedDriver_BankInit, with an arbitrary LED order. The bank keeps a
+// pointer to Map, which must stay valid while the bank is in use.
+LED_DRIVER_API int LedDriver_BankInitMapped(LedDriver_Bank* Bank, uint16_t* Address, bool InvertOutput, const LedDriver_Map* Map);
 
-bool LedDriver_IsOn(int16_t LedIndex);
+// Bank versions of LedDriver_Adopt. Status is the raw register image, as
+// held in LedDriver_Bank.status, and is written to the register once. Like
+// Init, Adopt detaches wear counters; see LedWear_Attach.
+LED_DRIVER_API int LedDriver_BankAdopt(LedDriver_Bank* Bank, uint16_t* Address, bool InvertOutput, bool InvertInput, uint16_t Status);
 
-bool LedDriver_IsOff(int16_t LedIndex);
+LED_DRIVER_API int LedDriver_BankAdoptMapped(LedDriver_Bank* Bank, uint16_t* Address, bool InvertOutput, const LedDriver_Map* Map, uint16_t Status);
+
+LED_DRIVER_API int LedDriver_BankTurnOn(LedDriver_Bank* Bank, int16_t LedIndex);
+
+LED_DRIVER_API int LedDriver_BankTurnOff(LedDriver_Bank* Bank, int16_t LedIndex);
+
+LED_DRIVER_API int LedDriver_BankTurnOnAll(LedDriver_Bank* Bank);
+
+LED_DRIVER_API int LedDriver_BankTurnOffAll(LedDriver_Bank* Bank);
+
+// Turns on every LED in TurnOnMask and off every LED in TurnOffMask with a
+// single register write. Bit n-1 of a mask is LED n; an LED in both masks
+// ends up on.
+LED_DRIVER_API int LedDriver_BankUpdate(LedDriver_Bank* Bank, uint16_t TurnOnMask, uint16_t TurnOffMask);
+
+// Register bits that drive the LEDs in LedMask, for use with UpdateBits
+LED_DRIVER_API uint16_t LedDriver_BankMapLeds(const LedDriver_Bank* Bank, uint16_t LedMask);
+
+// As LedDriver_BankUpdate with masks already converted by BankMapLeds
+LED_DRIVER_API int LedDriver_BankUpdateBits(LedDriver_Bank* Bank, uint16_t TurnOnBits, uint16_t TurnOffBits);
+
+LED_DRIVER_API bool LedDriver_BankIsOn(const LedDriver_Bank* Bank, int16_t LedIndex);
+
+LED_DRIVER_API bool LedDriver_BankIsOff(const LedDriver_Bank* Bank, int16_t LedIndex);
+
+// Points the bank at another register word, or at NULL to retire it, inside
+// the same sequence lock as re-initialisation. Nothing is written; modules
+// that stage a bank's writes (rate limiter, flush scheduler) attach with it.
+LED_DRIVER_API int LedDriver_BankRedirect(LedDriver_Bank* Bank, uint16_t* Address);
+
+// Copies the bank as one consistent snapshot, even while another thread
+// re-initialises it. Ordinary updates change a single word and never make a
+// reader retry; only a concurrent Init or Adopt does.
+LED_DRIVER_API int LedDriver_BankRead(const LedDriver_Bank* Bank, LedDriver_Bank* Copy);
+
+#ifdef LED_DRIVER_INLINE
+#include "LedDriverImpl.h"
+#endif
 
 // Catch2 is a C++ test framework, to link a C library you need these tags
 #ifdef __cplusplus
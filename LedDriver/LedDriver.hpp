@@ -0,0 +1,299 @@
+#ifndef _LED_DRIVER_HPP_
+#define _LED_DRIVER_HPP_
+
+// C++17 interface to the driver. Everything here is inline and only
+// forwards to the C API, so with the API inlined too (link the
+// LedDriver::cxx target, or define LED_DRIVER_INLINE before the first
+// include of LedDriver.h) the calls compile to the same code as using the
+// C functions directly.
+
+#include "LedDriver.h"
+#include "stdint.h"
+
+// RuntimeError.h has no C++ linkage tags of its own
+extern "C"
+{
+#include "RuntimeError.h"
+}
+
+#include <utility>
+
+namespace led
+{
+
+enum class Error : uint8_t
+{
+    None,
+    OutOfRange,
+    NotInitialised,
+};
+
+// Holds either a value or the Error that prevented it, in the manner of
+// C++23 std::expected. Results must be used.
+template <typename T>
+class [[nodiscard]] Expected
+{
+    public:
+        Expected(T&& Value) : value_(std::move(Value)), error_(Error::None) {}
+        Expected(Error Failure) : value_(), error_(Failure) {}
+
+        bool has_value() const { return Error::None == error_; }
+        explicit operator bool() const { return has_value(); }
+
+        T& value() & { return value_; }
+        T&& value() && { return std::move(value_); }
+        T& operator*() & { return value_; }
+        T* operator->() { return &value_; }
+
+        Error error() const { return error_; }
+
+    private:
+        T value_;
+        Error error_;
+};
+
+template <>
+class [[nodiscard]] Expected<void>
+{
+    public:
+        Expected() : error_(Error::None) {}
+        Expected(Error Failure) : error_(Failure) {}
+
+        bool has_value() const { return Error::None == error_; }
+        explicit operator bool() const { return has_value(); }
+
+        Error error() const { return error_; }
+
+    private:
+        Error error_;
+};
+
+using Status = Expected<void>;
+
+// Move-only handle owning one driver bank. create() only hands out banks
+// that initialised; a default-constructed or moved-from handle refuses every
+// call with Error::NotInitialised. C modules that keep a LedDriver_Bank
+// pointer (groups, compositor, rate limiter) must be given raw() of a handle
+// that is not moved while they use it.
+class LedBank
+{
+    public:
+        static Expected<LedBank> create(uint16_t* Address, bool InvertOutput = false, bool InvertInput = false)
+        {
+            LedBank bank;
+
+            if (0 != LedDriver_BankInit(&bank.bank_, Address, InvertOutput, InvertInput))
+            {
+                return Error::NotInitialised;
+            }
+
+            return bank;
+        }
+
+        static Expected<LedBank> create(uint16_t* Address, bool InvertOutput, const LedDriver_Map& Map)
+        {
+            LedBank bank;
+
+            if (0 != LedDriver_BankInitMapped(&bank.bank_, Address, InvertOutput, &Map))
+            {
+                return Error::NotInitialised;
+            }
+
+            return bank;
+        }
+
+        LedBank() : bank_() {}
+
+        LedBank(const LedBank&) = delete;
+        LedBank& operator=(const LedBank&) = delete;
+
+        LedBank(LedBank&& Other) noexcept : bank_(Other.bank_)
+        {
+            Other.bank_.address = nullptr;
+        }
+
+        LedBank& operator=(LedBank&& Other) noexcept
+        {
+            if (this != &Other)
+            {
+                bank_ = Other.bank_;
+                Other.bank_.address = nullptr;
+            }
+
+            return *this;
+        }
+
+        // Forced inline like LedTransaction's, so a call through the wrapper
+        // compiles to the same code as the C call it wraps
+        [[gnu::always_inline]] Status turnOn(int16_t LedIndex)
+        {
+            return status(LedDriver_BankTurnOn(&bank_, LedIndex), LedIndex);
+        }
+
+        [[gnu::always_inline]] Status turnOff(int16_t LedIndex)
+        {
+            return status(LedDriver_BankTurnOff(&bank_, LedIndex), LedIndex);
+        }
+
+        Status turnOnAll()
+        {
+            return status(LedDriver_BankTurnOnAll(&bank_), 1);
+        }
+
+        Status turnOffAll()
+        {
+            return status(LedDriver_BankTurnOffAll(&bank_), 1);
+        }
+
+        // Bit n-1 of a mask is LED n, see LedDriver_BankUpdate
+        Status update(uint16_t TurnOnMask, uint16_t TurnOffMask)
+        {
+            return status(LedDriver_BankUpdate(&bank_, TurnOnMask, TurnOffMask), 1);
+        }
+
+        bool isOn(int16_t LedIndex) const
+        {
+            return LedDriver_BankIsOn(&bank_, LedIndex);
+        }
+
+        bool isOff(int16_t LedIndex) const
+        {
+            return LedDriver_BankIsOff(&bank_, LedIndex);
+        }
+
+        explicit operator bool() const
+        {
+            return nullptr != bank_.address;
+        }
+
+        LedDriver_Bank* raw()
+        {
+            return &bank_;
+        }
+
+        const LedDriver_Bank* raw() const
+        {
+            return &bank_;
+        }
+
+    private:
+        // A call on a valid LED can only fail for want of a register. Worked
+        // out from the arguments rather than the bank, so that a result nobody
+        // looks at leaves no trace in the generated code.
+        static Status status(int Result, int16_t LedIndex)
+        {
+            if (0 == Result)
+            {
+                return Status();
+            }
+
+            return ((1 <= LedIndex) && (16 >= LedIndex)) ? Error::NotInitialised : Error::OutOfRange;
+        }
+
+        LedDriver_Bank bank_;
+};
+
+// Collects changes to a bank and writes them with one masked update when it
+// goes out of scope, or earlier with commit(). Later changes to an LED win
+// over earlier ones. An out-of-range LED is reported by the call that named
+// it, and through RUNTIME_ERROR like the C API, and leaves the rest of the
+// transaction untouched.
+class LedTransaction
+{
+    public:
+        explicit LedTransaction(LedBank& Bank) : bank_(Bank), on_(0), off_(0), open_(true) {}
+
+        LedTransaction(const LedTransaction&) = delete;
+        LedTransaction& operator=(const LedTransaction&) = delete;
+
+        ~LedTransaction()
+        {
+            if (true == open_)
+            {
+                (void)commit();
+            }
+        }
+
+        // Forced inline: the out-of-range report is a call, which keeps GCC
+        // from inlining these before it estimates branch weights, and the
+        // write after a constant LedIndex would be weighted as if the check
+        // could fail
+        [[gnu::always_inline]] Status turnOn(int16_t LedIndex)
+        {
+            if (false == isValidLed(LedIndex))
+            {
+                return outOfRange(LedIndex);
+            }
+
+            on_ |= bit(LedIndex);
+            off_ &= (uint16_t)~bit(LedIndex);
+
+            return Status();
+        }
+
+        [[gnu::always_inline]] Status turnOff(int16_t LedIndex)
+        {
+            if (false == isValidLed(LedIndex))
+            {
+                return outOfRange(LedIndex);
+            }
+
+            off_ |= bit(LedIndex);
+            on_ &= (uint16_t)~bit(LedIndex);
+
+            return Status();
+        }
+
+        void turnOnAll()
+        {
+            on_ = 0xFFFF;
+            off_ = 0;
+        }
+
+        void turnOffAll()
+        {
+            on_ = 0;
+            off_ = 0xFFFF;
+        }
+
+        // Writes the collected changes now; the destructor then does nothing
+        Status commit()
+        {
+            open_ = false;
+
+            return bank_.update(on_, off_);
+        }
+
+        // Drops the collected changes
+        void cancel()
+        {
+            open_ = false;
+        }
+
+    private:
+        static bool isValidLed(int16_t LedIndex)
+        {
+            return (1 <= LedIndex) && (16 >= LedIndex);
+        }
+
+        static Status outOfRange(int16_t LedIndex)
+        {
+            RUNTIME_ERROR("LED Driver: out-of-bounds LED", LedIndex);
+
+            return Error::OutOfRange;
+        }
+
+        static uint16_t bit(int16_t LedIndex)
+        {
+            return (uint16_t)(1u << (LedIndex - 1));
+        }
+
+        LedBank& bank_;
+        uint16_t on_;
+        uint16_t off_;
+        bool open_;
+};
+
+}
+
+#endif
@@ -0,0 +1,654 @@
+#ifndef _LED_DRIVER_IMPL_H_
+#define _LED_DRIVER_IMPL_H_
+
+// Driver implementation shared by LedDriver.c and the LED_DRIVER_INLINE build.
+// Include LedDriver.h rather than this file. In the inline build this lands in
+// every includer, so its static helpers carry the ledDriver_ prefix and its
+// macros are undefined again at the end.
+
+#include "LedAtomic.h"
+#include "RuntimeError.h"
+#include "LedWear.h"
+#include "LedRateLimit.h"
+#include "stddef.h"
+
+#ifdef LED_DRIVER_BUS
+#include "LedBus.h"
+#endif
+
+#define ALL_LEDS_ON 0xFFFF
+#define ALL_LEDS_OFF 0x0000
+#define MIN_LED 1
+#define MAX_LED 16
+#ifndef TRUE
+#define TRUE 1
+#define LED_DRIVER_IMPL_TRUE
+#endif
+#ifndef FALSE
+#define FALSE 0
+#define LED_DRIVER_IMPL_FALSE
+#endif
+
+// Branch and placement hints, dropped on compilers without them
+#if defined(__GNUC__) || defined(__clang__)
+#define LED_DRIVER_LIKELY(x) __builtin_expect((x), 1)
+#define LED_DRIVER_UNLIKELY(x) __builtin_expect((x), 0)
+#define LED_DRIVER_COLD __attribute__((cold, noinline))
+#else
+#define LED_DRIVER_LIKELY(x) (x)
+#define LED_DRIVER_UNLIKELY(x) (x)
+#define LED_DRIVER_COLD
+#endif
+
+static inline uint16_t ledDriver_ConvertLedNumberToBit(const LedDriver_Map* Map, uint16_t ledNumber);
+static inline uint16_t ledDriver_ConvertLedMaskToBits(const LedDriver_Bank* Bank, uint16_t ledMask);
+static inline void ledDriver_UpdateHardware(const LedDriver_Bank* Bank);
+static void ledDriver_RecordWrite(const LedDriver_Bank* Bank) LED_DRIVER_COLD;
+static inline uint8_t ledDriver_ValidateRequestedLed(int16_t LedIndex);
+static inline void ledDriver_SetLedBit(LedDriver_Bank* Bank, uint16_t LedIndex);
+static inline void ledDriver_ClearLedBit(LedDriver_Bank* Bank, uint16_t LedIndex);
+static inline void ledDriver_SetBit(LedDriver_Bank* Bank, uint16_t LedIndex);
+static inline void ledDriver_ClearBit(LedDriver_Bank* Bank, uint16_t LedIndex);
+static bool ledDriver_IsInitialised(const LedDriver_Bank* Bank);
+static inline uint16_t ledDriver_AllOffStatus(bool InvertOutput);
+static inline void ledDriver_SetStatus(LedDriver_Bank* Bank, uint16_t Status);
+static inline uint32_t ledDriver_BeginWrite(LedDriver_Bank* Bank);
+static inline void ledDriver_EndWrite(LedDriver_Bank* Bank, uint32_t Sequence);
+static int ledDriver_AdoptBank(LedDriver_Bank* Bank, uint16_t* Address, bool InvertOutput, bool InvertInput, const LedDriver_Map* Map, uint16_t Status);
+
+// State behind the original single-register API, defined in LedDriver.c
+extern LedDriver_Bank LedDriver_DefaultBank;
+
+// Built-in maps, defined once in LedDriver.c so that banks initialised in
+// any translation unit compare equal to them and take the shift fast paths
+extern const LedDriver_Map LedDriver_StraightMap;
+extern const LedDriver_Map LedDriver_ReversedMap;
+
+LED_DRIVER_API int LedDriver_Init(uint16_t* Address, bool InvertOutput, bool InvertInput)
+{
+    return LedDriver_BankInit(&LedDriver_DefaultBank, Address, InvertOutput, InvertInput);
+}
+
+LED_DRIVER_API int LedDriver_Adopt(uint16_t* Address, bool InvertOutput, bool InvertInput, uint16_t Status)
+{
+    return LedDriver_BankAdopt(&LedDriver_DefaultBank, Address, InvertOutput, InvertInput, Status);
+}
+
+LED_DRIVER_API int LedDriver_TurnOn(int16_t LedIndex)
+{
+    return LedDriver_BankTurnOn(&LedDriver_DefaultBank, LedIndex);
+}
+
+LED_DRIVER_API int LedDriver_TurnOff(int16_t LedIndex)
+{
+    return LedDriver_BankTurnOff(&LedDriver_DefaultBank, LedIndex);
+}
+
+LED_DRIVER_API int LedDriver_TurnOnAll(void)
+{
+    return LedDriver_BankTurnOnAll(&LedDriver_DefaultBank);
+}
+
+LED_DRIVER_API int LedDriver_TurnOffAll(void)
+{
+    return LedDriver_BankTurnOffAll(&LedDriver_DefaultBank);
+}
+
+LED_DRIVER_API bool LedDriver_IsOn(int16_t LedIndex)
+{
+    return LedDriver_BankIsOn(&LedDriver_DefaultBank, LedIndex);
+}
+
+LED_DRIVER_API bool LedDriver_IsOff(int16_t LedIndex)
+{
+    return LedDriver_BankIsOff(&LedDriver_DefaultBank, LedIndex);
+}
+
+LED_DRIVER_API LedDriver_Bank* LedDriver_GetDefaultBank(void)
+{
+    return &LedDriver_DefaultBank;
+}
+
+LED_DRIVER_API int LedDriver_BankInit(LedDriver_Bank* Bank, uint16_t* Address, bool InvertOutput, bool InvertInput)
+{
+    return LedDriver_BankAdopt(Bank, Address, InvertOutput, InvertInput, ledDriver_AllOffStatus(InvertOutput));
+}
+
+LED_DRIVER_API int LedDriver_BankAdopt(LedDriver_Bank* Bank, uint16_t* Address, bool InvertOutput, bool InvertInput, uint16_t Status)
+{
+    const LedDriver_Map* map;
+
+    if (TRUE == InvertInput)
+    {
+        map = &LedDriver_ReversedMap;
+    }
+    else
+    {
+        map = &LedDriver_StraightMap;
+    }
+
+    return ledDriver_AdoptBank(Bank, Address, InvertOutput, InvertInput, map, Status);
+}
+
+LED_DRIVER_API int LedDriver_MapInit(LedDriver_Map* Map, const uint8_t* PhysicalBits)
+{
+    int result;
+    uint16_t used;
+    uint16_t bit;
+    uint8_t i;
+
+    result = -1;
+
+    if ((NULL != Map) && (NULL != PhysicalBits))
+    {
+        used = 0;
+
+        for (i = 0; i < MAX_LED; i++)
+        {
+            if (PhysicalBits[i] < MAX_LED)
+            {
+                bit = (uint16_t)(1 << PhysicalBits[i]);
+                used |= bit;
+                Map->bits[i] = bit;
+            }
+        }
+
+        if (ALL_LEDS_ON == used)
+        {
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+LED_DRIVER_API int LedDriver_BankInitMapped(LedDriver_Bank* Bank, uint16_t* Address, bool InvertOutput, const LedDriver_Map* Map)
+{
+    return LedDriver_BankAdoptMapped(Bank, Address, InvertOutput, Map, ledDriver_AllOffStatus(InvertOutput));
+}
+
+LED_DRIVER_API int LedDriver_BankAdoptMapped(LedDriver_Bank* Bank, uint16_t* Address, bool InvertOutput, const LedDriver_Map* Map, uint16_t Status)
+{
+    return ledDriver_AdoptBank(Bank, Address, InvertOutput, FALSE, Map, Status);
+}
+
+LED_DRIVER_API int LedDriver_BankTurnOn(LedDriver_Bank* Bank, int16_t LedIndex)
+{
+    int result;
+
+    result = -1;
+
+    if (TRUE == ledDriver_IsInitialised(Bank))
+    {
+        if (TRUE == ledDriver_ValidateRequestedLed(LedIndex))
+        {
+            ledDriver_SetLedBit(Bank, LedIndex);
+            ledDriver_UpdateHardware(Bank);
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+LED_DRIVER_API int LedDriver_BankTurnOff(LedDriver_Bank* Bank, int16_t LedIndex)
+{
+    int result;
+
+    result = -1;
+
+    if (TRUE == ledDriver_IsInitialised(Bank))
+    {
+        if (TRUE == ledDriver_ValidateRequestedLed(LedIndex))
+        {
+            ledDriver_ClearLedBit(Bank, LedIndex);
+            ledDriver_UpdateHardware(Bank);
+
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+LED_DRIVER_API int LedDriver_BankTurnOnAll(LedDriver_Bank* Bank)
+{
+    int result;
+
+    result = -1;
+
+    if (TRUE == ledDriver_IsInitialised(Bank))
+    {
+        result = 0;
+
+        if (TRUE == Bank->inverted_output)
+        {
+            ledDriver_SetStatus(Bank, ALL_LEDS_OFF);
+        }
+        else
+        {
+            ledDriver_SetStatus(Bank, ALL_LEDS_ON);
+        }
+
+        ledDriver_UpdateHardware(Bank);
+    }
+
+    return result;
+}
+
+LED_DRIVER_API int LedDriver_BankTurnOffAll(LedDriver_Bank* Bank)
+{
+    int result;
+
+    result = -1;
+
+    if (TRUE == ledDriver_IsInitialised(Bank))
+    {
+        result = 0;
+
+        if (TRUE == Bank->inverted_output)
+        {
+            ledDriver_SetStatus(Bank, ALL_LEDS_ON);
+        }
+        else
+        {
+            ledDriver_SetStatus(Bank, ALL_LEDS_OFF);
+        }
+
+        ledDriver_UpdateHardware(Bank);
+    }
+
+    return result;
+}
+
+LED_DRIVER_API int LedDriver_BankUpdate(LedDriver_Bank* Bank, uint16_t TurnOnMask, uint16_t TurnOffMask)
+{
+    int result;
+
+    result = -1;
+
+    if (TRUE == ledDriver_IsInitialised(Bank))
+    {
+        result = LedDriver_BankUpdateBits(Bank, ledDriver_ConvertLedMaskToBits(Bank, TurnOnMask), ledDriver_ConvertLedMaskToBits(Bank, TurnOffMask));
+    }
+
+    return result;
+}
+
+LED_DRIVER_API uint16_t LedDriver_BankMapLeds(const LedDriver_Bank* Bank, uint16_t LedMask)
+{
+    uint16_t bits;
+
+    bits = 0;
+
+    if (TRUE == ledDriver_IsInitialised(Bank))
+    {
+        bits = ledDriver_ConvertLedMaskToBits(Bank, LedMask);
+    }
+
+    return bits;
+}
+
+LED_DRIVER_API int LedDriver_BankUpdateBits(LedDriver_Bank* Bank, uint16_t TurnOnBits, uint16_t TurnOffBits)
+{
+    int result;
+    uint16_t offBits;
+
+    result = -1;
+
+    if (TRUE == ledDriver_IsInitialised(Bank))
+    {
+        offBits = TurnOffBits & ~TurnOnBits;
+
+        if (TRUE == Bank->inverted_output)
+        {
+            ledDriver_SetStatus(Bank, (Bank->status | offBits) & ~TurnOnBits);
+        }
+        else
+        {
+            ledDriver_SetStatus(Bank, (Bank->status & ~offBits) | TurnOnBits);
+        }
+
+        ledDriver_UpdateHardware(Bank);
+
+        result = 0;
+    }
+
+    return result;
+}
+
+LED_DRIVER_API bool LedDriver_BankIsOn(const LedDriver_Bank* Bank, int16_t LedIndex)
+{
+    bool status;
+    const uint16_t* address;
+    const LedDriver_Map* map;
+    uint32_t sequence;
+    uint16_t bits;
+    bool invertedOutput;
+
+    status = FALSE;
+
+    if (NULL != Bank)
+    {
+        // The map, polarity and register copy only change together under
+        // re-initialisation, so this loop only repeats if it raced one
+        do
+        {
+            sequence = LED_ATOMIC_LOAD(&Bank->sequence);
+            address = LED_ATOMIC_LOAD_RELAXED(&Bank->address);
+            map = LED_ATOMIC_LOAD_RELAXED(&Bank->map);
+            invertedOutput = LED_ATOMIC_LOAD_RELAXED(&Bank->inverted_output);
+            bits = LED_ATOMIC_LOAD_RELAXED(&Bank->status);
+            LED_ATOMIC_FENCE_ACQUIRE();
+        } while ((0 != (sequence & 1)) || (sequence != LED_ATOMIC_LOAD_RELAXED(&Bank->sequence)));
+
+        // A bank whose Init failed has no map worth reading
+        if ((NULL != address) && (NULL != map) && (TRUE == ledDriver_ValidateRequestedLed(LedIndex)))
+        {
+            if (TRUE == invertedOutput)
+            {
+                status = (FALSE == (bits & ledDriver_ConvertLedNumberToBit(map, LedIndex)));
+            }
+            else
+            {
+                status = (0 != (bits & ledDriver_ConvertLedNumberToBit(map, LedIndex)));
+            }
+        }
+    }
+
+    return status;
+}
+
+LED_DRIVER_API bool LedDriver_BankIsOff(const LedDriver_Bank* Bank, int16_t LedIndex)
+{
+    return (FALSE == LedDriver_BankIsOn(Bank, LedIndex));
+}
+
+LED_DRIVER_API int LedDriver_BankRedirect(LedDriver_Bank* Bank, uint16_t* Address)
+{
+    int result;
+    uint32_t sequence;
+
+    result = -1;
+
+    if (NULL != Bank)
+    {
+        sequence = ledDriver_BeginWrite(Bank);
+        LED_ATOMIC_STORE_RELAXED(&Bank->address, Address);
+        ledDriver_EndWrite(Bank, sequence);
+
+        result = 0;
+    }
+
+    return result;
+}
+
+LED_DRIVER_API int LedDriver_BankRead(const LedDriver_Bank* Bank, LedDriver_Bank* Copy)
+{
+    int result;
+    uint32_t sequence;
+
+    result = -1;
+
+    if ((NULL != Bank) && (NULL != Copy))
+    {
+        do
+        {
+            sequence = LED_ATOMIC_LOAD(&Bank->sequence);
+            Copy->address = LED_ATOMIC_LOAD_RELAXED(&Bank->address);
+            Copy->map = LED_ATOMIC_LOAD_RELAXED(&Bank->map);
+            Copy->wear = LED_ATOMIC_LOAD_RELAXED(&Bank->wear);
+            Copy->limit = LED_ATOMIC_LOAD_RELAXED(&Bank->limit);
+            Copy->status = LED_ATOMIC_LOAD_RELAXED(&Bank->status);
+            Copy->inverted_output = LED_ATOMIC_LOAD_RELAXED(&Bank->inverted_output);
+            Copy->inverted_input = LED_ATOMIC_LOAD_RELAXED(&Bank->inverted_input);
+            LED_ATOMIC_FENCE_ACQUIRE();
+        } while ((0 != (sequence & 1)) || (sequence != LED_ATOMIC_LOAD_RELAXED(&Bank->sequence)));
+
+        Copy->sequence = sequence;
+
+        result = 0;
+    }
+
+    return result;
+}
+
+static inline uint16_t ledDriver_ConvertLedNumberToBit(const LedDriver_Map* Map, uint16_t ledNumber)
+{
+    uint16_t bit;
+
+    // The built-in maps are a shift; only custom maps need the table load
+    if (&LedDriver_StraightMap == Map)
+    {
+        bit = (uint16_t)(1 << (ledNumber - 1));
+    }
+    else if (&LedDriver_ReversedMap == Map)
+    {
+        bit = (uint16_t)(1 << (MAX_LED - ledNumber));
+    }
+    else
+    {
+        bit = Map->bits[ledNumber - 1];
+    }
+
+    return bit;
+}
+
+static inline uint16_t ledDriver_ConvertLedMaskToBits(const LedDriver_Bank* Bank, uint16_t ledMask)
+{
+    uint16_t bits;
+    uint8_t i;
+
+    if (&LedDriver_StraightMap == Bank->map)
+    {
+        bits = ledMask;
+    }
+    else if (&LedDriver_ReversedMap == Bank->map)
+    {
+        // Reverse the 16 bits so LED 1 lands on bit 15
+        bits = ledMask;
+        bits = ((bits & 0x5555) << 1) | ((bits >> 1) & 0x5555);
+        bits = ((bits & 0x3333) << 2) | ((bits >> 2) & 0x3333);
+        bits = ((bits & 0x0F0F) << 4) | ((bits >> 4) & 0x0F0F);
+        bits = (uint16_t)((bits << 8) | (bits >> 8));
+    }
+    else
+    {
+        bits = 0;
+
+        for (i = 0; i < MAX_LED; i++)
+        {
+            if (0 != (ledMask & (1 << i)))
+            {
+                bits |= Bank->map->bits[i];
+            }
+        }
+    }
+
+    return bits;
+}
+
+static inline void ledDriver_UpdateHardware(const LedDriver_Bank* Bank)
+{
+    // Counted before the store so that the store stays the last thing a
+    // driver call does. Banks without counters or a limiter are the common
+    // case and pay one test for both.
+    if (LED_DRIVER_UNLIKELY(0 != ((uintptr_t)Bank->wear | (uintptr_t)Bank->limit)))
+    {
+        ledDriver_RecordWrite(Bank);
+    }
+
+#ifdef LED_DRIVER_BUS
+    LedBus_Store(Bank->address, LED_ATOMIC_LOAD_RELAXED(&Bank->status));
+#else
+    *Bank->address = LED_ATOMIC_LOAD_RELAXED(&Bank->status);
+#endif
+}
+
+// Out of line and cold, so callers carry only the test in ledDriver_UpdateHardware
+static void ledDriver_RecordWrite(const LedDriver_Bank* Bank)
+{
+    if (NULL != Bank->wear)
+    {
+        LedWear_Record(Bank);
+    }
+
+    if (NULL != Bank->limit)
+    {
+        LedRateLimit_Record(Bank);
+    }
+}
+
+static inline uint8_t ledDriver_ValidateRequestedLed(int16_t LedIndex)
+{
+    uint8_t result = FALSE;
+
+    // Out-of-range LEDs are the error path; keep it out of the inlined calls
+    if (LED_DRIVER_LIKELY((MIN_LED <= LedIndex) && (MAX_LED >= LedIndex)))
+    {
+        result = TRUE;
+    }
+    else
+    {
+        RUNTIME_ERROR("LED Driver: out-of-bounds LED", LedIndex);
+    }
+
+    return result;
+}
+
+static inline void ledDriver_SetLedBit(LedDriver_Bank* Bank, uint16_t LedIndex)
+{
+    if (TRUE == Bank->inverted_output)
+    {
+        ledDriver_ClearBit(Bank, LedIndex);
+    }
+    else
+    {
+        ledDriver_SetBit(Bank, LedIndex);
+    }
+}
+
+static inline void ledDriver_ClearLedBit(LedDriver_Bank* Bank, uint16_t LedIndex)
+{
+    if (TRUE == Bank->inverted_output)
+    {
+        ledDriver_SetBit(Bank, LedIndex);
+    }
+    else
+    {
+        ledDriver_ClearBit(Bank, LedIndex);
+    }
+}
+
+static inline void ledDriver_SetBit(LedDriver_Bank* Bank, uint16_t LedIndex)
+{
+    ledDriver_SetStatus(Bank, Bank->status | ledDriver_ConvertLedNumberToBit(Bank->map, LedIndex));
+}
+
+static inline void ledDriver_ClearBit(LedDriver_Bank* Bank, uint16_t LedIndex)
+{
+    ledDriver_SetStatus(Bank, Bank->status & ~(ledDriver_ConvertLedNumberToBit(Bank->map, LedIndex)));
+}
+
+static bool ledDriver_IsInitialised(const LedDriver_Bank* Bank)
+{
+    return ((NULL != Bank) && (NULL != Bank->address));
+}
+
+static inline uint16_t ledDriver_AllOffStatus(bool InvertOutput)
+{
+    uint16_t status;
+
+    if (TRUE == InvertOutput)
+    {
+        status = ALL_LEDS_ON;
+    }
+    else
+    {
+        status = ALL_LEDS_OFF;
+    }
+
+    return status;
+}
+
+// The writer is the only thread changing status; the store is atomic only
+// because readers load it concurrently
+static inline void ledDriver_SetStatus(LedDriver_Bank* Bank, uint16_t Status)
+{
+    LED_ATOMIC_STORE_RELAXED(&Bank->status, Status);
+}
+
+// Opens a sequence lock write section: the count is odd until ledDriver_EndWrite,
+// whatever the bank held before
+static inline uint32_t ledDriver_BeginWrite(LedDriver_Bank* Bank)
+{
+    uint32_t sequence;
+
+    sequence = LED_ATOMIC_LOAD_RELAXED(&Bank->sequence) | 1;
+    LED_ATOMIC_STORE_RELAXED(&Bank->sequence, sequence);
+    LED_ATOMIC_FENCE_RELEASE();
+
+    return sequence;
+}
+
+static inline void ledDriver_EndWrite(LedDriver_Bank* Bank, uint32_t Sequence)
+{
+    LED_ATOMIC_STORE(&Bank->sequence, Sequence + 1);
+}
+
+// Replaces the whole state of a bank inside a sequence lock write section
+static int ledDriver_AdoptBank(LedDriver_Bank* Bank, uint16_t* Address, bool InvertOutput, bool InvertInput, const LedDriver_Map* Map, uint16_t Status)
+{
+    int result;
+    uint32_t sequence;
+
+    result = -1;
+
+    if ((NULL != Bank) && (NULL != Map))
+    {
+        sequence = ledDriver_BeginWrite(Bank);
+
+        LED_ATOMIC_STORE_RELAXED(&Bank->address, Address);
+
+        // Counters and limiters attached before describe some other register
+        LED_ATOMIC_STORE_RELAXED(&Bank->wear, NULL);
+        LED_ATOMIC_STORE_RELAXED(&Bank->limit, NULL);
+
+        if (TRUE == ledDriver_IsInitialised(Bank))
+        {
+            LED_ATOMIC_STORE_RELAXED(&Bank->map, Map);
+            LED_ATOMIC_STORE_RELAXED(&Bank->inverted_output, InvertOutput);
+            LED_ATOMIC_STORE_RELAXED(&Bank->inverted_input, InvertInput);
+            ledDriver_SetStatus(Bank, Status);
+
+            result = 0;
+        }
+
+        ledDriver_EndWrite(Bank, sequence);
+
+        if (0 == result)
+        {
+            ledDriver_UpdateHardware(Bank);
+        }
+    }
+
+    return result;
+}
+
+#undef ALL_LEDS_ON
+#undef ALL_LEDS_OFF
+#undef MIN_LED
+#undef MAX_LED
+#undef LED_DRIVER_LIKELY
+#undef LED_DRIVER_UNLIKELY
+#undef LED_DRIVER_COLD
+#ifdef LED_DRIVER_IMPL_TRUE
+#undef TRUE
+#undef LED_DRIVER_IMPL_TRUE
+#endif
+#ifdef LED_DRIVER_IMPL_FALSE
+#undef FALSE
+#undef LED_DRIVER_IMPL_FALSE
+#endif
+
+#endif
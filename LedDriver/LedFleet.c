@@ -0,0 +1,378 @@
+#include "LedFleet.h"
+#include "LedAtomic.h"
+#include "LedPool.h"
+#include "pthread.h"
+#include "stddef.h"
+
+#define TRUE 1
+#define FALSE 0
+
+// Polls of the batch generation before an idle worker goes to sleep
+#define SPIN_LIMIT 4096
+
+// Each worker owns a run of operations [begin, end) packed into one word so
+// the owner (taking from the front) and thieves (taking from the back) can
+// claim work with a single CAS
+typedef struct
+{
+    _Alignas(LED_POOL_CACHE_LINE) uint64_t range;
+    uint32_t applied;
+} WorkerQueue;
+
+static inline uint64_t makeRange(uint32_t begin, uint32_t end);
+static inline uint32_t rangeBegin(uint64_t range);
+static inline uint32_t rangeEnd(uint64_t range);
+static bool takeOwn(WorkerQueue* queue, uint32_t* begin, uint32_t* end);
+static bool steal(uint32_t self, uint32_t* begin, uint32_t* end);
+static uint32_t applyRange(uint32_t begin, uint32_t end);
+static void runBatch(uint32_t self);
+static void* workerMain(void* argument);
+
+static WorkerQueue queues[LED_FLEET_MAX_THREADS];
+static pthread_t workers[LED_FLEET_MAX_THREADS];
+static uint32_t workerCount;
+
+static pthread_mutex_t applyLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wake = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t done = PTHREAD_COND_INITIALIZER;
+
+static const LedFleet_Op* batchOps;
+static uint64_t generation;
+static uint64_t launchGeneration;
+static uint32_t activeWorkers;
+static uint32_t stopping;
+
+static uint64_t batchCount;
+static uint64_t operationCount;
+static uint64_t stealCount;
+
+int LedFleet_Start(uint32_t Threads)
+{
+    int result;
+    bool created;
+    uint32_t i;
+
+    result = -1;
+    created = FALSE;
+
+    pthread_mutex_lock(&applyLock);
+
+    if ((0 == workerCount) && (0 < Threads) && (LED_FLEET_MAX_THREADS >= Threads))
+    {
+        LED_ATOMIC_STORE(&stopping, FALSE);
+        launchGeneration = generation;
+        batchCount = 0;
+        operationCount = 0;
+        LED_ATOMIC_STORE(&stealCount, 0);
+        result = 0;
+        created = TRUE;
+
+        for (i = 0; i < Threads; i++)
+        {
+            queues[i].range = makeRange(0, 0);
+
+            if (0 != pthread_create(&workers[i], NULL, workerMain, (void*)(uintptr_t)i))
+            {
+                result = -1;
+                break;
+            }
+
+            workerCount++;
+        }
+    }
+
+    pthread_mutex_unlock(&applyLock);
+
+    // Only the workers this call started are undone; a refused Start leaves
+    // a running pool alone
+    if ((TRUE == created) && (0 != result))
+    {
+        LedFleet_Stop();
+    }
+
+    return result;
+}
+
+int LedFleet_Apply(const LedFleet_Op* Ops, uint32_t Count)
+{
+    int result;
+    uint32_t i;
+    uint32_t begin;
+    uint32_t end;
+
+    result = -1;
+
+    pthread_mutex_lock(&applyLock);
+
+    if ((0 != workerCount) && ((NULL != Ops) || (0 == Count)))
+    {
+        // Contiguous shares, cut on chunk boundaries
+        for (i = 0; i < workerCount; i++)
+        {
+            begin = (uint32_t)(((uint64_t)Count * i) / workerCount);
+            end = (uint32_t)(((uint64_t)Count * (i + 1)) / workerCount);
+
+            begin -= begin % LED_FLEET_CHUNK;
+
+            if ((i + 1) < workerCount)
+            {
+                end -= end % LED_FLEET_CHUNK;
+            }
+
+            queues[i].applied = 0;
+            LED_ATOMIC_STORE(&queues[i].range, makeRange(begin, (begin < end) ? end : begin));
+        }
+
+        pthread_mutex_lock(&lock);
+
+        batchOps = Ops;
+        activeWorkers = workerCount;
+        LED_ATOMIC_STORE(&generation, generation + 1);
+        pthread_cond_broadcast(&wake);
+
+        while (0 != activeWorkers)
+        {
+            pthread_cond_wait(&done, &lock);
+        }
+
+        pthread_mutex_unlock(&lock);
+
+        result = 0;
+
+        for (i = 0; i < workerCount; i++)
+        {
+            result += (int)queues[i].applied;
+        }
+
+        batchCount++;
+        operationCount += Count;
+    }
+
+    pthread_mutex_unlock(&applyLock);
+
+    return result;
+}
+
+void LedFleet_Stop(void)
+{
+    uint32_t i;
+
+    pthread_mutex_lock(&applyLock);
+
+    pthread_mutex_lock(&lock);
+    LED_ATOMIC_STORE(&stopping, TRUE);
+    pthread_cond_broadcast(&wake);
+    pthread_mutex_unlock(&lock);
+
+    for (i = 0; i < workerCount; i++)
+    {
+        pthread_join(workers[i], NULL);
+    }
+
+    workerCount = 0;
+
+    pthread_mutex_unlock(&applyLock);
+}
+
+void LedFleet_GetStats(LedFleet_Stats* Stats)
+{
+    if (NULL != Stats)
+    {
+        pthread_mutex_lock(&applyLock);
+
+        Stats->threads = workerCount;
+        Stats->batches = batchCount;
+        Stats->operations = operationCount;
+        Stats->steals = LED_ATOMIC_LOAD(&stealCount);
+
+        pthread_mutex_unlock(&applyLock);
+    }
+}
+
+static inline uint64_t makeRange(uint32_t begin, uint32_t end)
+{
+    return (((uint64_t)end) << 32) | begin;
+}
+
+static inline uint32_t rangeBegin(uint64_t range)
+{
+    return (uint32_t)(range & 0xFFFFFFFF);
+}
+
+static inline uint32_t rangeEnd(uint64_t range)
+{
+    return (uint32_t)(range >> 32);
+}
+
+static bool takeOwn(WorkerQueue* queue, uint32_t* begin, uint32_t* end)
+{
+    uint64_t range;
+    uint32_t first;
+    uint32_t last;
+
+    range = LED_ATOMIC_LOAD(&queue->range);
+
+    do
+    {
+        first = rangeBegin(range);
+        last = rangeEnd(range);
+
+        if (first >= last)
+        {
+            return FALSE;
+        }
+
+        if ((last - first) > LED_FLEET_CHUNK)
+        {
+            last = first + LED_FLEET_CHUNK;
+        }
+    }
+    while (FALSE == LED_ATOMIC_CAS(&queue->range, &range, makeRange(last, rangeEnd(range))));
+
+    *begin = first;
+    *end = last;
+
+    return TRUE;
+}
+
+static bool steal(uint32_t self, uint32_t* begin, uint32_t* end)
+{
+    uint32_t i;
+    uint32_t victim;
+    uint64_t range;
+    uint32_t first;
+    uint32_t last;
+    uint32_t split;
+
+    for (i = 1; i < workerCount; i++)
+    {
+        victim = (self + i) % workerCount;
+        range = LED_ATOMIC_LOAD(&queues[victim].range);
+
+        do
+        {
+            first = rangeBegin(range);
+            last = rangeEnd(range);
+
+            if (first >= last)
+            {
+                break;
+            }
+
+            // Take the back half, rounded to whole chunks
+            split = first + ((last - first) / 2);
+            split -= (split - first) % LED_FLEET_CHUNK;
+        }
+        while (FALSE == LED_ATOMIC_CAS(&queues[victim].range, &range, makeRange(first, split)));
+
+        if (first < last)
+        {
+            *begin = split;
+            *end = last;
+
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+static uint32_t applyRange(uint32_t begin, uint32_t end)
+{
+    uint32_t applied;
+    uint32_t i;
+
+    applied = 0;
+
+    for (i = begin; i < end; i++)
+    {
+        if (0 == LedDriver_BankUpdate(batchOps[i].bank, batchOps[i].turn_on, batchOps[i].turn_off))
+        {
+            applied++;
+        }
+    }
+
+    return applied;
+}
+
+static void runBatch(uint32_t self)
+{
+    WorkerQueue* queue;
+    uint32_t begin;
+    uint32_t end;
+
+    queue = &queues[self];
+
+    for (;;)
+    {
+        if (TRUE == takeOwn(queue, &begin, &end))
+        {
+            queue->applied += applyRange(begin, end);
+        }
+        else if (TRUE == steal(self, &begin, &end))
+        {
+            // Park the stolen run in our own queue so others can steal from it too
+            LED_ATOMIC_FETCH_ADD(&stealCount, 1);
+            LED_ATOMIC_STORE(&queue->range, makeRange(begin, end));
+        }
+        else
+        {
+            break;
+        }
+    }
+}
+
+static void* workerMain(void* argument)
+{
+    uint32_t self;
+    uint64_t seen;
+    uint32_t spins;
+
+    self = (uint32_t)(uintptr_t)argument;
+
+    // Apply cannot run until Start returns, so this is the generation every
+    // worker starts from even if it is scheduled after the first batch
+    seen = launchGeneration;
+
+    for (;;)
+    {
+        spins = 0;
+
+        while ((seen == LED_ATOMIC_LOAD(&generation)) && (FALSE == LED_ATOMIC_LOAD(&stopping)) && (spins < SPIN_LIMIT))
+        {
+            spins++;
+        }
+
+        pthread_mutex_lock(&lock);
+
+        while ((seen == generation) && (FALSE == stopping))
+        {
+            pthread_cond_wait(&wake, &lock);
+        }
+
+        pthread_mutex_unlock(&lock);
+
+        if (TRUE == LED_ATOMIC_LOAD(&stopping))
+        {
+            break;
+        }
+
+        seen = LED_ATOMIC_LOAD(&generation);
+
+        runBatch(self);
+
+        pthread_mutex_lock(&lock);
+
+        activeWorkers--;
+
+        if (0 == activeWorkers)
+        {
+            pthread_cond_signal(&done);
+        }
+
+        pthread_mutex_unlock(&lock);
+    }
+
+    return NULL;
+}
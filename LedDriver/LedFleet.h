@@ -0,0 +1,58 @@
+#ifndef _LED_FLEET_H_
+#define _LED_FLEET_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "LedDriver.h"
+
+// Catch2 is a C++ test framework, to link a C library you need these tags
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef LED_FLEET_MAX_THREADS
+#define LED_FLEET_MAX_THREADS 64
+#endif
+
+// Operations are handed out in runs of this many so neighbouring banks, and
+// usually their registers, stay with one worker
+#ifndef LED_FLEET_CHUNK
+#define LED_FLEET_CHUNK 32
+#endif
+
+// One masked update for one bank, see LedDriver_BankUpdate
+typedef struct
+{
+    LedDriver_Bank* bank;
+    uint16_t turn_on;
+    uint16_t turn_off;
+} LedFleet_Op;
+
+typedef struct
+{
+    uint32_t threads;
+    uint64_t batches;
+    uint64_t operations;
+    uint64_t steals;
+} LedFleet_Stats;
+
+// Starts Threads worker threads. Returns -1 if already running or Threads is
+// outside 1..LED_FLEET_MAX_THREADS; a pool already running is left as it is.
+int LedFleet_Start(uint32_t Threads);
+
+// Applies every operation in parallel and returns once each bank's register
+// has been written. Returns the number of banks updated, or -1 if the pool
+// is not running. A bank may appear at most once per batch.
+int LedFleet_Apply(const LedFleet_Op* Ops, uint32_t Count);
+
+void LedFleet_Stop(void);
+
+// Counters since the last successful Start
+void LedFleet_GetStats(LedFleet_Stats* Stats);
+
+// Catch2 is a C++ test framework, to link a C library you need these tags
+#ifdef __cplusplus
+}
+#endif
+
+#endif
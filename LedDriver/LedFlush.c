@@ -0,0 +1,415 @@
+#include "LedFlush.h"
+#include "stddef.h"
+
+#ifdef LED_DRIVER_BUS
+#include "LedBus.h"
+#endif
+
+#define TRUE 1
+#define FALSE 0
+
+#define NONE 0xFFFF
+
+static bool isValidIndex(const LedFlush* Flush, int Index);
+static bool isAdded(const LedFlush* Flush, const LedDriver_Bank* Bank);
+static bool isPending(const LedFlush* Flush, uint16_t Index);
+static void collect(LedFlush* Flush, uint32_t Now);
+static void flushBurst(LedFlush* Flush, uint16_t Index, uint32_t Now);
+static bool isEarlier(const LedFlush* Flush, uint16_t A, uint16_t B);
+static void heapPush(LedFlush* Flush, uint16_t Index);
+static void heapRemove(LedFlush* Flush, uint16_t Position);
+static void heapSet(LedFlush* Flush, uint16_t Position, uint16_t Index);
+static void siftUp(LedFlush* Flush, uint16_t Position);
+static void siftDown(LedFlush* Flush, uint16_t Position);
+static uint16_t earlierChild(const LedFlush* Flush, uint16_t Position);
+
+int LedFlush_Init(LedFlush* Flush)
+{
+    int result;
+
+    result = -1;
+
+    if (NULL != Flush)
+    {
+        Flush->banks = 0;
+        Flush->queued = 0;
+        Flush->stats.bursts = 0;
+        Flush->stats.registers = 0;
+        Flush->stats.merged = 0;
+        Flush->stats.cancelled = 0;
+        Flush->stats.missed = 0;
+        Flush->stats.max_lateness = 0;
+
+        result = 0;
+    }
+
+    return result;
+}
+
+int LedFlush_Add(LedFlush* Flush, LedDriver_Bank* Bank, uint32_t Deadline)
+{
+    int result;
+    LedFlush_Entry* entry;
+    uint16_t id;
+    uint16_t i;
+
+    result = -1;
+
+    if ((NULL != Flush) && (NULL != Bank) && (NULL != Bank->address) && (LED_FLUSH_MAX_BANKS > Flush->banks)
+        && (FALSE == isAdded(Flush, Bank)))
+    {
+        id = Flush->banks;
+        entry = &Flush->entry[id];
+
+        entry->below = NONE;
+        entry->above = NONE;
+
+        for (i = 0; i < id; i++)
+        {
+            if ((Flush->entry[i].hardware + 1) == Bank->address)
+            {
+                entry->below = i;
+            }
+            else if (Flush->entry[i].hardware == (Bank->address + 1))
+            {
+                entry->above = i;
+            }
+        }
+
+        if (NONE != entry->below)
+        {
+            Flush->entry[entry->below].above = id;
+        }
+
+        if (NONE != entry->above)
+        {
+            Flush->entry[entry->above].below = id;
+        }
+
+        entry->bank = Bank;
+        entry->hardware = Bank->address;
+        entry->staging = Bank->status;
+        entry->written = Bank->status;
+        entry->relative_deadline = Deadline;
+        entry->deadline = 0;
+        entry->heap_position = NONE;
+        entry->queued = FALSE;
+
+        (void)LedDriver_BankRedirect(Bank, &entry->staging);
+        Flush->banks++;
+
+        result = id;
+    }
+
+    return result;
+}
+
+int LedFlush_SetDeadline(LedFlush* Flush, int Index, uint32_t Deadline)
+{
+    int result;
+
+    result = -1;
+
+    if (TRUE == isValidIndex(Flush, Index))
+    {
+        Flush->entry[Index].relative_deadline = Deadline;
+
+        result = 0;
+    }
+
+    return result;
+}
+
+int LedFlush_Service(LedFlush* Flush, uint32_t Now, uint32_t MaxBursts)
+{
+    int result;
+    uint32_t bursts;
+    uint16_t next;
+
+    result = -1;
+
+    if (NULL != Flush)
+    {
+        collect(Flush, Now);
+
+        bursts = 0;
+
+        while ((bursts < MaxBursts) && (0 < Flush->queued))
+        {
+            next = Flush->heap[0];
+
+            if (Flush->entry[next].staging == Flush->entry[next].written)
+            {
+                // Changed and changed back while waiting
+                heapRemove(Flush, 0);
+                Flush->entry[next].queued = FALSE;
+                Flush->stats.cancelled++;
+            }
+            else
+            {
+                flushBurst(Flush, next, Now);
+                bursts++;
+            }
+        }
+
+        result = (int)bursts;
+    }
+
+    return result;
+}
+
+int LedFlush_Detach(LedFlush* Flush, uint32_t Now)
+{
+    int result;
+    uint16_t i;
+
+    result = -1;
+
+    if (NULL != Flush)
+    {
+        (void)LedFlush_Service(Flush, Now, UINT32_MAX);
+
+        for (i = 0; i < Flush->banks; i++)
+        {
+            (void)LedDriver_BankRedirect(Flush->entry[i].bank, Flush->entry[i].hardware);
+        }
+
+        Flush->banks = 0;
+
+        result = 0;
+    }
+
+    return result;
+}
+
+void LedFlush_GetStats(const LedFlush* Flush, LedFlush_Stats* Stats)
+{
+    if ((NULL != Flush) && (NULL != Stats))
+    {
+        *Stats = Flush->stats;
+    }
+}
+
+static bool isValidIndex(const LedFlush* Flush, int Index)
+{
+    return ((NULL != Flush) && (0 <= Index) && (Flush->banks > Index));
+}
+
+static bool isAdded(const LedFlush* Flush, const LedDriver_Bank* Bank)
+{
+    bool result;
+    uint16_t i;
+
+    result = FALSE;
+
+    for (i = 0; i < Flush->banks; i++)
+    {
+        if ((Flush->entry[i].bank == Bank) || (Flush->entry[i].hardware == Bank->address))
+        {
+            result = TRUE;
+        }
+    }
+
+    return result;
+}
+
+// Queued with a change still to write
+static bool isPending(const LedFlush* Flush, uint16_t Index)
+{
+    return ((NONE != Index) && (TRUE == Flush->entry[Index].queued)
+            && (Flush->entry[Index].staging != Flush->entry[Index].written));
+}
+
+static void collect(LedFlush* Flush, uint32_t Now)
+{
+    LedFlush_Entry* entry;
+    uint16_t i;
+
+    for (i = 0; i < Flush->banks; i++)
+    {
+        entry = &Flush->entry[i];
+
+        if ((FALSE == entry->queued) && (entry->staging != entry->written))
+        {
+            entry->deadline = Now + entry->relative_deadline;
+            entry->queued = TRUE;
+
+            heapPush(Flush, i);
+        }
+    }
+}
+
+static void flushBurst(LedFlush* Flush, uint16_t Index, uint32_t Now)
+{
+    uint16_t values[LED_FLUSH_MAX_BURST];
+    LedFlush_Entry* entry;
+    uint16_t first;
+    uint16_t last;
+    uint16_t count;
+    uint16_t i;
+    uint16_t k;
+    uint32_t lateness;
+
+    // Widen the burst over pending neighbours on both sides. A queued
+    // neighbour changed back since stays out and is cancelled from the heap.
+    first = Index;
+    last = Index;
+    count = 1;
+
+    while ((LED_FLUSH_MAX_BURST > count) && (TRUE == isPending(Flush, Flush->entry[first].below)))
+    {
+        first = Flush->entry[first].below;
+        count++;
+    }
+
+    while ((LED_FLUSH_MAX_BURST > count) && (TRUE == isPending(Flush, Flush->entry[last].above)))
+    {
+        last = Flush->entry[last].above;
+        count++;
+    }
+
+    i = first;
+
+    for (k = 0; k < count; k++)
+    {
+        entry = &Flush->entry[i];
+
+        values[k] = entry->staging;
+
+        heapRemove(Flush, entry->heap_position);
+        entry->queued = FALSE;
+        entry->written = entry->staging;
+
+        Flush->stats.registers++;
+
+        if (i != Index)
+        {
+            Flush->stats.merged++;
+        }
+
+        lateness = Now - entry->deadline;
+
+        if (0 < (int32_t)lateness)
+        {
+            Flush->stats.missed++;
+
+            if (lateness > Flush->stats.max_lateness)
+            {
+                Flush->stats.max_lateness = lateness;
+            }
+        }
+
+        i = entry->above;
+    }
+
+#ifdef LED_DRIVER_BUS
+    LedBus_StoreBurst(Flush->entry[first].hardware, values, count);
+#else
+    for (k = 0; k < count; k++)
+    {
+        Flush->entry[first].hardware[k] = values[k];
+    }
+#endif
+
+    Flush->stats.bursts++;
+}
+
+static bool isEarlier(const LedFlush* Flush, uint16_t A, uint16_t B)
+{
+    int32_t difference;
+
+    difference = (int32_t)(Flush->entry[A].deadline - Flush->entry[B].deadline);
+
+    // Equal deadlines go in the order the banks were added
+    return (0 != difference) ? (0 > difference) : (A < B);
+}
+
+static void heapPush(LedFlush* Flush, uint16_t Index)
+{
+    heapSet(Flush, Flush->queued, Index);
+    Flush->queued++;
+
+    siftUp(Flush, (uint16_t)(Flush->queued - 1));
+}
+
+static void heapRemove(LedFlush* Flush, uint16_t Position)
+{
+    uint16_t moved;
+
+    Flush->entry[Flush->heap[Position]].heap_position = NONE;
+    Flush->queued--;
+
+    // The last entry fills the hole and may belong either side of it
+    if (Position != Flush->queued)
+    {
+        moved = Flush->heap[Flush->queued];
+
+        heapSet(Flush, Position, moved);
+
+        siftUp(Flush, Position);
+        siftDown(Flush, Flush->entry[moved].heap_position);
+    }
+}
+
+static void heapSet(LedFlush* Flush, uint16_t Position, uint16_t Index)
+{
+    Flush->heap[Position] = Index;
+    Flush->entry[Index].heap_position = Position;
+}
+
+static void siftUp(LedFlush* Flush, uint16_t Position)
+{
+    uint16_t index;
+    uint16_t parent;
+
+    index = Flush->heap[Position];
+    parent = (uint16_t)((Position - 1) / 2);
+
+    while ((0 < Position) && (TRUE == isEarlier(Flush, index, Flush->heap[parent])))
+    {
+        heapSet(Flush, Position, Flush->heap[parent]);
+        Position = parent;
+        parent = (uint16_t)((Position - 1) / 2);
+    }
+
+    heapSet(Flush, Position, index);
+}
+
+static void siftDown(LedFlush* Flush, uint16_t Position)
+{
+    uint16_t index;
+    uint16_t child;
+
+    index = Flush->heap[Position];
+    child = earlierChild(Flush, Position);
+
+    while ((NONE != child) && (TRUE == isEarlier(Flush, Flush->heap[child], index)))
+    {
+        heapSet(Flush, Position, Flush->heap[child]);
+        Position = child;
+        child = earlierChild(Flush, Position);
+    }
+
+    heapSet(Flush, Position, index);
+}
+
+static uint16_t earlierChild(const LedFlush* Flush, uint16_t Position)
+{
+    uint32_t child;
+    uint16_t result;
+
+    result = NONE;
+    child = (2u * Position) + 1;
+
+    if (child < Flush->queued)
+    {
+        result = (uint16_t)child;
+
+        if (((child + 1) < Flush->queued) && (TRUE == isEarlier(Flush, Flush->heap[child + 1], Flush->heap[child])))
+        {
+            result = (uint16_t)(child + 1);
+        }
+    }
+
+    return result;
+}
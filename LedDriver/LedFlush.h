@@ -0,0 +1,85 @@
+#ifndef _LED_FLUSH_H_
+#define _LED_FLUSH_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "LedDriver.h"
+
+// Catch2 is a C++ test framework, to link a C library you need these tags
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef LED_FLUSH_MAX_BANKS
+#define LED_FLUSH_MAX_BANKS 256
+#endif
+
+#ifndef LED_FLUSH_MAX_BURST
+#define LED_FLUSH_MAX_BURST 16
+#endif
+
+typedef struct
+{
+    uint32_t bursts;            // bus transactions
+    uint32_t registers;         // registers written
+    uint32_t merged;            // registers written early in a neighbour's burst
+    uint32_t cancelled;         // changes undone before they were written
+    uint32_t missed;            // registers written after their deadline
+    uint32_t max_lateness;      // worst overrun in ticks
+} LedFlush_Stats;
+
+typedef struct
+{
+    LedDriver_Bank* bank;
+    uint16_t* hardware;
+    uint16_t staging;
+    uint16_t written;
+    uint32_t relative_deadline;
+    uint32_t deadline;
+    uint16_t below;             // bank whose register is just before this one
+    uint16_t above;             // bank whose register is just after this one
+    uint16_t heap_position;
+    bool queued;
+} LedFlush_Entry;
+
+// Defers the register writes of many banks sharing one bus and flushes them
+// earliest deadline first. While added, a bank's driver writes go into a
+// staging word here; Service notices changed banks, gives each the deadline
+// Now + its relative deadline, then writes the most urgent ones. Dirty banks
+// whose registers are adjacent go out together as one burst. Times are in
+// caller-defined ticks and may wrap.
+typedef struct
+{
+    uint16_t banks;
+    uint16_t queued;
+    LedFlush_Entry entry[LED_FLUSH_MAX_BANKS];
+    uint16_t heap[LED_FLUSH_MAX_BANKS];
+    LedFlush_Stats stats;
+} LedFlush;
+
+int LedFlush_Init(LedFlush* Flush);
+
+// Takes over an initialised bank whose register is not already added. Small
+// deadlines flush first, so alarms get short ones. Returns the bank's index
+// or -1. The struct must not move while banks are added.
+int LedFlush_Add(LedFlush* Flush, LedDriver_Bank* Bank, uint32_t Deadline);
+
+// Applies from the bank's next change
+int LedFlush_SetDeadline(LedFlush* Flush, int Index, uint32_t Deadline);
+
+// Queues changed banks and writes up to MaxBursts bursts. Returns the number
+// of bursts written or -1 on bad arguments. Every bank is checked, so call
+// it at least as often as the shortest deadline.
+int LedFlush_Service(LedFlush* Flush, uint32_t Now, uint32_t MaxBursts);
+
+// Writes everything pending and points every bank back at its register
+int LedFlush_Detach(LedFlush* Flush, uint32_t Now);
+
+void LedFlush_GetStats(const LedFlush* Flush, LedFlush_Stats* Stats);
+
+// Catch2 is a C++ test framework, to link a C library you need these tags
+#ifdef __cplusplus
+}
+#endif
+
+#endif
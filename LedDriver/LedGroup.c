@@ -0,0 +1,131 @@
+#include "LedGroup.h"
+#include "RuntimeError.h"
+#include "stddef.h"
+#include "string.h"
+
+#define MIN_LED 1
+#define MAX_LED 16
+#define TRUE 1
+#define FALSE 0
+
+static int updateGroup(const LedGroup* Group, bool TurnOn);
+
+int LedGroup_Init(LedGroup* Group, const char* Name)
+{
+    int result;
+
+    result = -1;
+
+    if (NULL != Group)
+    {
+        Group->name = Name;
+        Group->parts = 0;
+
+        result = 0;
+    }
+
+    return result;
+}
+
+int LedGroup_Add(LedGroup* Group, LedDriver_Bank* Bank, int16_t LedIndex)
+{
+    int result;
+    uint16_t bits;
+    uint8_t i;
+
+    result = -1;
+
+    if ((MIN_LED > LedIndex) || (MAX_LED < LedIndex))
+    {
+        RUNTIME_ERROR("LED Group: out-of-bounds LED", LedIndex);
+    }
+    else if (NULL != Group)
+    {
+        bits = LedDriver_BankMapLeds(Bank, (uint16_t)(1 << (LedIndex - 1)));
+
+        if (0 != bits)
+        {
+            for (i = 0; i < Group->parts; i++)
+            {
+                if (Bank == Group->part[i].bank)
+                {
+                    break;
+                }
+            }
+
+            if (i < LED_GROUP_MAX_BANKS)
+            {
+                if (i == Group->parts)
+                {
+                    Group->part[i].bank = Bank;
+                    Group->part[i].bits = 0;
+                    Group->parts++;
+                }
+
+                Group->part[i].bits |= bits;
+
+                result = 0;
+            }
+        }
+    }
+
+    return result;
+}
+
+int LedGroup_TurnOn(const LedGroup* Group)
+{
+    return updateGroup(Group, TRUE);
+}
+
+int LedGroup_TurnOff(const LedGroup* Group)
+{
+    return updateGroup(Group, FALSE);
+}
+
+const LedGroup* LedGroup_Find(const LedGroup* Groups, uint32_t Count, const char* Name)
+{
+    const LedGroup* found;
+    uint32_t i;
+
+    found = NULL;
+
+    if ((NULL != Groups) && (NULL != Name))
+    {
+        for (i = 0; (i < Count) && (NULL == found); i++)
+        {
+            if ((NULL != Groups[i].name) && (0 == strcmp(Groups[i].name, Name)))
+            {
+                found = &Groups[i];
+            }
+        }
+    }
+
+    return found;
+}
+
+static int updateGroup(const LedGroup* Group, bool TurnOn)
+{
+    int result;
+    uint8_t i;
+
+    result = -1;
+
+    if (NULL != Group)
+    {
+        result = 0;
+
+        for (i = 0; i < Group->parts; i++)
+        {
+            if (TRUE == TurnOn)
+            {
+                result |= LedDriver_BankUpdateBits(Group->part[i].bank, Group->part[i].bits, 0);
+            }
+            else
+            {
+                result |= LedDriver_BankUpdateBits(Group->part[i].bank, 0, Group->part[i].bits);
+            }
+        }
+    }
+
+    return result;
+}
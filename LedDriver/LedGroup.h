@@ -0,0 +1,54 @@
+#ifndef _LED_GROUP_H_
+#define _LED_GROUP_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "LedDriver.h"
+
+// Catch2 is a C++ test framework, to link a C library you need these tags
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Number of registers a single group may span
+#ifndef LED_GROUP_MAX_BANKS
+#define LED_GROUP_MAX_BANKS 8
+#endif
+
+// Register bits of one bank that belong to the group
+typedef struct
+{
+    LedDriver_Bank* bank;
+    uint16_t bits;
+} LedGroup_Part;
+
+// A named set of LEDs, precompiled into one register mask per bank so that
+// switching the group costs one masked write per bank it touches. Masks are
+// taken from each bank's map when the LED is added; re-initialising a bank
+// with another map means rebuilding its groups.
+typedef struct
+{
+    const char* name;
+    uint8_t parts;
+    LedGroup_Part part[LED_GROUP_MAX_BANKS];
+} LedGroup;
+
+int LedGroup_Init(LedGroup* Group, const char* Name);
+
+// Adds logical LED LedIndex of Bank to the group. Returns -1 for bad LEDs,
+// uninitialised banks or when the group already spans LED_GROUP_MAX_BANKS.
+int LedGroup_Add(LedGroup* Group, LedDriver_Bank* Bank, int16_t LedIndex);
+
+int LedGroup_TurnOn(const LedGroup* Group);
+
+int LedGroup_TurnOff(const LedGroup* Group);
+
+// Returns the group called Name, or NULL
+const LedGroup* LedGroup_Find(const LedGroup* Groups, uint32_t Count, const char* Name);
+
+// Catch2 is a C++ test framework, to link a C library you need these tags
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,208 @@
+#include "LedPool.h"
+#include "LedAtomic.h"
+#include "LedWear.h"
+#include "stddef.h"
+
+#define TRUE 1
+#define FALSE 0
+
+// Free list links and the list head hold slot index + 1 so that zeroed
+// storage reads as an empty list rather than a cycle through slot 0
+#define END_OF_LIST 0
+
+typedef struct
+{
+    _Alignas(LED_POOL_CACHE_LINE) LedDriver_Bank bank;
+    uint32_t next;
+    uint32_t in_use;
+} PoolSlot;
+
+static inline uint64_t makeHead(uint32_t link, uint32_t tag);
+static inline uint32_t headLink(uint64_t head);
+static inline uint32_t headTag(uint64_t head);
+static uint32_t popSlot(void);
+static void pushSlot(uint32_t link);
+static PoolSlot* slotFromBank(LedDriver_Bank* Bank);
+static void recordHighWater(uint32_t inUse);
+
+static PoolSlot slots[LED_POOL_CAPACITY];
+
+// Link in the low word, ABA tag in the high word, swapped with one CAS
+static uint64_t freeHead;
+static uint32_t inUseCount;
+static uint32_t highWater;
+static uint32_t exhaustedCount;
+
+int LedPool_Init(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < LED_POOL_CAPACITY; i++)
+    {
+        slots[i].bank.address = NULL;
+        slots[i].next = ((i + 1) < LED_POOL_CAPACITY) ? (i + 2) : END_OF_LIST;
+        slots[i].in_use = FALSE;
+    }
+
+    LED_ATOMIC_STORE(&inUseCount, 0);
+    LED_ATOMIC_STORE(&highWater, 0);
+    LED_ATOMIC_STORE(&exhaustedCount, 0);
+    LED_ATOMIC_STORE(&freeHead, makeHead(1, 0));
+
+    return 0;
+}
+
+LedDriver_Bank* LedPool_Acquire(uint16_t* Address, bool InvertOutput, bool InvertInput)
+{
+    LedDriver_Bank* bank;
+    uint32_t link;
+
+    bank = NULL;
+
+    if (NULL != Address)
+    {
+        link = popSlot();
+
+        if (END_OF_LIST == link)
+        {
+            LED_ATOMIC_FETCH_ADD(&exhaustedCount, 1);
+        }
+        else
+        {
+            PoolSlot* slot = &slots[link - 1];
+
+            LED_ATOMIC_STORE(&slot->in_use, TRUE);
+            recordHighWater(LED_ATOMIC_FETCH_ADD(&inUseCount, 1) + 1);
+
+            bank = &slot->bank;
+            LedDriver_BankInit(bank, Address, InvertOutput, InvertInput);
+        }
+    }
+
+    return bank;
+}
+
+int LedPool_Release(LedDriver_Bank* Bank)
+{
+    int result;
+    PoolSlot* slot;
+
+    result = -1;
+
+    slot = slotFromBank(Bank);
+
+    if (NULL != slot)
+    {
+        if (TRUE == LED_ATOMIC_EXCHANGE(&slot->in_use, FALSE))
+        {
+            // Counters keep the on-time run up to now; the next owner's Init
+            // would otherwise drop them silently
+            (void)LedWear_Detach(&slot->bank);
+
+            // Stale handles fail the driver's initialised check from now on
+            (void)LedDriver_BankRedirect(&slot->bank, NULL);
+
+            LED_ATOMIC_FETCH_SUB(&inUseCount, 1);
+            pushSlot((uint32_t)(slot - slots) + 1);
+
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+void LedPool_GetStats(LedPool_Stats* Stats)
+{
+    if (NULL != Stats)
+    {
+        Stats->capacity = LED_POOL_CAPACITY;
+        Stats->in_use = LED_ATOMIC_LOAD(&inUseCount);
+        Stats->high_water = LED_ATOMIC_LOAD(&highWater);
+        Stats->exhausted = LED_ATOMIC_LOAD(&exhaustedCount);
+    }
+}
+
+static inline uint64_t makeHead(uint32_t link, uint32_t tag)
+{
+    return (((uint64_t)tag) << 32) | link;
+}
+
+static inline uint32_t headLink(uint64_t head)
+{
+    return (uint32_t)(head & 0xFFFFFFFF);
+}
+
+static inline uint32_t headTag(uint64_t head)
+{
+    return (uint32_t)(head >> 32);
+}
+
+static uint32_t popSlot(void)
+{
+    uint64_t head;
+    uint64_t next;
+    uint32_t link;
+
+    head = LED_ATOMIC_LOAD(&freeHead);
+
+    do
+    {
+        link = headLink(head);
+
+        if (END_OF_LIST == link)
+        {
+            break;
+        }
+
+        // May read a link that is being rewritten; the tag makes the CAS fail then
+        next = makeHead(LED_ATOMIC_LOAD_RELAXED(&slots[link - 1].next), headTag(head) + 1);
+    }
+    while (FALSE == LED_ATOMIC_CAS(&freeHead, &head, next));
+
+    return link;
+}
+
+static void pushSlot(uint32_t link)
+{
+    uint64_t head;
+
+    head = LED_ATOMIC_LOAD(&freeHead);
+
+    do
+    {
+        LED_ATOMIC_STORE_RELAXED(&slots[link - 1].next, headLink(head));
+    }
+    while (FALSE == LED_ATOMIC_CAS(&freeHead, &head, makeHead(link, headTag(head) + 1)));
+}
+
+static PoolSlot* slotFromBank(LedDriver_Bank* Bank)
+{
+    PoolSlot* slot;
+    uintptr_t offset;
+
+    slot = NULL;
+
+    if ((uintptr_t)Bank >= (uintptr_t)&slots[0])
+    {
+        offset = (uintptr_t)Bank - (uintptr_t)&slots[0];
+
+        if ((offset < sizeof(slots)) && (0 == (offset % sizeof(PoolSlot))))
+        {
+            slot = &slots[offset / sizeof(PoolSlot)];
+        }
+    }
+
+    return slot;
+}
+
+static void recordHighWater(uint32_t inUse)
+{
+    uint32_t seen;
+
+    seen = LED_ATOMIC_LOAD(&highWater);
+
+    while ((seen < inUse) && (FALSE == LED_ATOMIC_CAS(&highWater, &seen, inUse)))
+    {
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef _LED_POOL_H_
+#define _LED_POOL_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "LedDriver.h"
+
+// Catch2 is a C++ test framework, to link a C library you need these tags
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Number of banks held by the pool, override at build time if needed
+#ifndef LED_POOL_CAPACITY
+#define LED_POOL_CAPACITY 64
+#endif
+
+// Each bank gets a cache line of its own so banks used by different
+// threads never share one
+#ifndef LED_POOL_CACHE_LINE
+#define LED_POOL_CACHE_LINE 64
+#endif
+
+typedef struct
+{
+    uint32_t capacity;
+    uint32_t in_use;
+    uint32_t high_water;
+    uint32_t exhausted;
+} LedPool_Stats;
+
+// Returns every bank to the pool. Call once at boot, before any Acquire.
+int LedPool_Init(void);
+
+// Takes a bank from the pool and initialises it on Address. Returns NULL
+// when the pool is empty, not initialised or the bank cannot be initialised.
+LedDriver_Bank* LedPool_Acquire(uint16_t* Address, bool InvertOutput, bool InvertInput);
+
+// Hands a bank back to the pool, detaching its wear counters (LedWear.h)
+// with their running on-time folded in. Returns -1 for banks that did not
+// come from the pool or were already released.
+int LedPool_Release(LedDriver_Bank* Bank);
+
+void LedPool_GetStats(LedPool_Stats* Stats);
+
+// Catch2 is a C++ test framework, to link a C library you need these tags
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,178 @@
+#include "LedRateLimit.h"
+#include "stddef.h"
+
+#ifdef LED_DRIVER_BUS
+#include "LedBus.h"
+#endif
+
+static void writeHardware(LedRateLimit* Limit, uint32_t Now);
+
+int LedRateLimit_Init(LedRateLimit* Limit, LedDriver_Bank* Bank, uint32_t MinInterval, uint32_t Now)
+{
+    int result;
+
+    result = -1;
+
+    // Attached already, the bank's address is some limiter's staging word,
+    // not the register, and taking it as the register would lose that word
+    if ((NULL != Limit) && (NULL != Bank) && (NULL != Bank->address) && (NULL == Bank->limit))
+    {
+        Limit->bank = Bank;
+        Limit->hardware = Bank->address;
+        Limit->staging = Bank->status;
+        Limit->written = Bank->status;
+        Limit->critical_bits = 0;
+        Limit->min_interval = MinInterval;
+        Limit->last_write = Now - MinInterval;
+        Limit->pending = 0;
+        Limit->stats.writes = 0;
+        Limit->stats.superseded = 0;
+        Limit->stats.forced = 0;
+
+        Bank->limit = Limit;
+        (void)LedDriver_BankRedirect(Bank, &Limit->staging);
+
+        result = 0;
+    }
+
+    return result;
+}
+
+int LedRateLimit_Detach(LedRateLimit* Limit)
+{
+    int result;
+
+    result = -1;
+
+    if ((NULL != Limit) && (NULL != Limit->bank))
+    {
+        if (Limit->staging != Limit->written)
+        {
+            writeHardware(Limit, Limit->last_write);
+        }
+
+        // A bank re-initialised since has left the limiter already
+        if (Limit == Limit->bank->limit)
+        {
+            (void)LedDriver_BankRedirect(Limit->bank, Limit->hardware);
+            Limit->bank->limit = NULL;
+        }
+
+        Limit->bank = NULL;
+
+        result = 0;
+    }
+
+    return result;
+}
+
+int LedRateLimit_SetCritical(LedRateLimit* Limit, uint16_t LedMask)
+{
+    int result;
+
+    result = -1;
+
+    if ((NULL != Limit) && (NULL != Limit->bank))
+    {
+        Limit->critical_bits = LedDriver_BankMapLeds(Limit->bank, LedMask);
+
+        result = 0;
+    }
+
+    return result;
+}
+
+int LedRateLimit_Service(LedRateLimit* Limit, uint32_t Now)
+{
+    int result;
+    uint16_t changed;
+
+    result = -1;
+
+    if ((NULL != Limit) && (NULL != Limit->bank))
+    {
+        result = 0;
+
+        changed = Limit->staging ^ Limit->written;
+
+        if (0 == changed)
+        {
+            // Changed and changed back within the window: nothing to write
+            Limit->stats.superseded += Limit->pending;
+            Limit->pending = 0;
+        }
+        else if ((Now - Limit->last_write) >= Limit->min_interval)
+        {
+            writeHardware(Limit, Now);
+
+            result = 1;
+        }
+        else if (0 != (changed & Limit->critical_bits))
+        {
+            Limit->stats.forced++;
+
+            writeHardware(Limit, Now);
+
+            result = 1;
+        }
+    }
+
+    return result;
+}
+
+int LedRateLimit_Flush(LedRateLimit* Limit, uint32_t Now)
+{
+    int result;
+
+    result = -1;
+
+    if ((NULL != Limit) && (NULL != Limit->bank))
+    {
+        result = 0;
+
+        if (Limit->staging != Limit->written)
+        {
+            Limit->stats.forced++;
+
+            writeHardware(Limit, Now);
+
+            result = 1;
+        }
+    }
+
+    return result;
+}
+
+void LedRateLimit_GetStats(const LedRateLimit* Limit, LedRateLimit_Stats* Stats)
+{
+    if ((NULL != Limit) && (NULL != Stats))
+    {
+        *Stats = Limit->stats;
+    }
+}
+
+void LedRateLimit_Record(const LedDriver_Bank* Bank)
+{
+    Bank->limit->pending++;
+}
+
+static void writeHardware(LedRateLimit* Limit, uint32_t Now)
+{
+#ifdef LED_DRIVER_BUS
+    LedBus_Store(Limit->hardware, Limit->staging);
+#else
+    *Limit->hardware = Limit->staging;
+#endif
+
+    Limit->written = Limit->staging;
+    Limit->last_write = Now;
+    Limit->stats.writes++;
+
+    // Every driver write in this window except the one written was superseded
+    if (0 < Limit->pending)
+    {
+        Limit->stats.superseded += Limit->pending - 1;
+    }
+
+    Limit->pending = 0;
+}
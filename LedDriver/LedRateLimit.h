@@ -0,0 +1,73 @@
+#ifndef _LED_RATE_LIMIT_H_
+#define _LED_RATE_LIMIT_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "LedDriver.h"
+
+// Catch2 is a C++ test framework, to link a C library you need these tags
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// superseded counts driver writes absorbed by the staging word that never
+// reached the register: replaced by a later one, undone or changing nothing.
+// Each would have been a register write without the limiter, so
+// superseded / (superseded + writes) is the share of writes saved. forced
+// counts writes made before the interval was up, by Flush or for a critical
+// LED.
+typedef struct
+{
+    uint32_t writes;
+    uint32_t superseded;
+    uint32_t forced;
+} LedRateLimit_Stats;
+
+// Caps how often a bank's register is written. While attached, the driver
+// writes into a staging word inside this struct and LedRateLimit_Service
+// copies the latest state to the register at most once per MinInterval.
+// A change to a critical LED is written by the next Service call without
+// waiting out the interval. A change is written no later than MinInterval
+// after it happened, provided Service is called at least that often. Times
+// are in caller-defined ticks and may wrap.
+typedef struct LedRateLimit
+{
+    LedDriver_Bank* bank;
+    uint16_t* hardware;
+    uint16_t staging;
+    uint16_t written;
+    uint16_t critical_bits;
+    uint32_t min_interval;
+    uint32_t last_write;
+    uint32_t pending;           // driver writes since the last register write
+    LedRateLimit_Stats stats;
+} LedRateLimit;
+
+// Attaches to an initialised bank. The struct must not move while attached.
+// Fails on a bank already attached to any limiter; detach it first.
+int LedRateLimit_Init(LedRateLimit* Limit, LedDriver_Bank* Bank, uint32_t MinInterval, uint32_t Now);
+
+// Points the bank back at its register after writing any pending state
+int LedRateLimit_Detach(LedRateLimit* Limit);
+
+// Changes to LEDs in LedMask are written by the next Service, whatever the
+// interval. Nothing reaches the register between Service calls.
+int LedRateLimit_SetCritical(LedRateLimit* Limit, uint16_t LedMask);
+
+// Returns 1 if the register was written, 0 if not, -1 on bad arguments
+int LedRateLimit_Service(LedRateLimit* Limit, uint32_t Now);
+
+// Writes any pending state now, regardless of the limit
+int LedRateLimit_Flush(LedRateLimit* Limit, uint32_t Now);
+
+void LedRateLimit_GetStats(const LedRateLimit* Limit, LedRateLimit_Stats* Stats);
+
+// Called by the driver for each write of a bank with a limiter attached
+void LedRateLimit_Record(const LedDriver_Bank* Bank);
+
+// Catch2 is a C++ test framework, to link a C library you need these tags
+#ifdef __cplusplus
+}
+#endif
+
+#endif
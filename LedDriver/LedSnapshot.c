@@ -0,0 +1,324 @@
+#include "LedSnapshot.h"
+#include "LedAtomic.h"
+#include "fcntl.h"
+#include "string.h"
+#include "sys/mman.h"
+#include "sys/stat.h"
+#include "unistd.h"
+
+#define TRUE 1
+#define FALSE 0
+
+#define SNAPSHOT_MAGIC 0x4C454453u
+#define SNAPSHOT_VERSION 1
+#define SLOTS 2
+#define NO_SLOT -1
+
+#define FLAG_INVERTED_OUTPUT 0x01
+#define FLAG_INVERTED_INPUT 0x02
+
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t banks;
+    uint32_t sequence;
+    uint32_t checksum;
+    uint32_t reserved;
+} SlotHeader;
+
+typedef struct
+{
+    uint16_t status;
+    uint8_t flags;
+    uint8_t reserved;
+    uint16_t bits[16];
+} BankRecord;
+
+static size_t slotSize(uint32_t Banks);
+static SlotHeader* slotHeader(const LedSnapshot* Snapshot, int Slot);
+static BankRecord* slotRecords(const LedSnapshot* Snapshot, int Slot);
+static uint32_t checksum(const LedSnapshot* Snapshot, int Slot, uint32_t Sequence);
+static bool isValidSlot(const LedSnapshot* Snapshot, int Slot);
+static bool matchesBuiltInMap(const BankRecord* Record);
+
+int LedSnapshot_Open(LedSnapshot* Snapshot, const char* Path, uint32_t Banks)
+{
+    int result;
+    struct stat info;
+    void* base;
+    int slot;
+
+    result = -1;
+
+    if ((NULL != Snapshot) && (NULL != Path) && (0 < Banks))
+    {
+        Snapshot->base = NULL;
+        Snapshot->size = SLOTS * slotSize(Banks);
+        Snapshot->banks = Banks;
+        Snapshot->latest = NO_SLOT;
+        Snapshot->fd = open(Path, O_RDWR | O_CREAT, 0644);
+
+        if (0 <= Snapshot->fd)
+        {
+            if ((0 == fstat(Snapshot->fd, &info)) &&
+                (((size_t)info.st_size == Snapshot->size) || (0 == ftruncate(Snapshot->fd, (off_t)Snapshot->size))))
+            {
+                base = mmap(NULL, Snapshot->size, PROT_READ | PROT_WRITE, MAP_SHARED, Snapshot->fd, 0);
+
+                if (MAP_FAILED != base)
+                {
+                    Snapshot->base = (uint8_t*)base;
+                    result = 0;
+
+                    for (slot = 0; slot < SLOTS; slot++)
+                    {
+                        if ((TRUE == isValidSlot(Snapshot, slot)) &&
+                            ((NO_SLOT == Snapshot->latest) ||
+                             (0 < (int32_t)(slotHeader(Snapshot, slot)->sequence - slotHeader(Snapshot, Snapshot->latest)->sequence))))
+                        {
+                            Snapshot->latest = slot;
+                            result = 1;
+                        }
+                    }
+                }
+            }
+
+            if (-1 == result)
+            {
+                close(Snapshot->fd);
+                Snapshot->fd = -1;
+            }
+        }
+    }
+
+    return result;
+}
+
+void LedSnapshot_Close(LedSnapshot* Snapshot)
+{
+    if ((NULL != Snapshot) && (NULL != Snapshot->base))
+    {
+        munmap(Snapshot->base, Snapshot->size);
+        close(Snapshot->fd);
+
+        Snapshot->base = NULL;
+        Snapshot->fd = -1;
+        Snapshot->latest = NO_SLOT;
+    }
+}
+
+int LedSnapshot_Save(LedSnapshot* Snapshot, LedDriver_Bank* const* Banks, uint32_t Count)
+{
+    int result;
+    SlotHeader* header;
+    BankRecord* record;
+    const LedDriver_Bank* bank;
+    uint32_t sequence;
+    uint32_t i;
+    int slot;
+
+    result = -1;
+
+    if ((NULL != Snapshot) && (NULL != Snapshot->base) && (NULL != Banks) && (Count == Snapshot->banks))
+    {
+        for (i = 0; i < Count; i++)
+        {
+            if ((NULL == Banks[i]) || (NULL == Banks[i]->map))
+            {
+                break;
+            }
+        }
+
+        if (i == Count)
+        {
+            // Overwrite the older copy, and mark it invalid before touching
+            // the records so a torn save is never mistaken for a good one
+            if (0 == Snapshot->latest)
+            {
+                slot = 1;
+            }
+            else
+            {
+                slot = 0;
+            }
+
+            sequence = 1;
+
+            if (NO_SLOT != Snapshot->latest)
+            {
+                sequence = slotHeader(Snapshot, Snapshot->latest)->sequence + 1;
+            }
+
+            header = slotHeader(Snapshot, slot);
+            record = slotRecords(Snapshot, slot);
+
+            LED_ATOMIC_STORE_RELAXED(&header->magic, 0);
+            LED_ATOMIC_FENCE();
+
+            for (i = 0; i < Count; i++)
+            {
+                bank = Banks[i];
+
+                record[i].status = bank->status;
+                record[i].flags = 0;
+                record[i].reserved = 0;
+
+                if (TRUE == bank->inverted_output)
+                {
+                    record[i].flags |= FLAG_INVERTED_OUTPUT;
+                }
+
+                if (TRUE == bank->inverted_input)
+                {
+                    record[i].flags |= FLAG_INVERTED_INPUT;
+                }
+
+                memcpy(record[i].bits, bank->map->bits, sizeof(record[i].bits));
+            }
+
+            header->version = SNAPSHOT_VERSION;
+            header->record_size = sizeof(BankRecord);
+            header->banks = Count;
+            header->sequence = sequence;
+            header->checksum = checksum(Snapshot, slot, sequence);
+            header->reserved = 0;
+
+            LED_ATOMIC_STORE(&header->magic, SNAPSHOT_MAGIC);
+
+            Snapshot->latest = slot;
+
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+int LedSnapshot_Sync(LedSnapshot* Snapshot)
+{
+    int result;
+
+    result = -1;
+
+    if ((NULL != Snapshot) && (NULL != Snapshot->base))
+    {
+        result = msync(Snapshot->base, Snapshot->size, MS_SYNC);
+    }
+
+    return result;
+}
+
+int LedSnapshot_Restore(const LedSnapshot* Snapshot, uint32_t Index, LedDriver_Bank* Bank, uint16_t* Address, const LedDriver_Map* Map)
+{
+    int result;
+    const BankRecord* record;
+    bool invertOutput;
+    bool invertInput;
+
+    result = -1;
+
+    if ((NULL != Snapshot) && (NULL != Snapshot->base) && (NO_SLOT != Snapshot->latest) && (Index < Snapshot->banks))
+    {
+        record = &slotRecords(Snapshot, Snapshot->latest)[Index];
+
+        invertOutput = (0 != (record->flags & FLAG_INVERTED_OUTPUT));
+        invertInput = (0 != (record->flags & FLAG_INVERTED_INPUT));
+
+        if (NULL == Map)
+        {
+            if (TRUE == matchesBuiltInMap(record))
+            {
+                result = LedDriver_BankAdopt(Bank, Address, invertOutput, invertInput, record->status);
+            }
+        }
+        else if (0 == memcmp(Map->bits, record->bits, sizeof(record->bits)))
+        {
+            result = LedDriver_BankAdoptMapped(Bank, Address, invertOutput, Map, record->status);
+        }
+    }
+
+    return result;
+}
+
+static size_t slotSize(uint32_t Banks)
+{
+    size_t size;
+
+    // Keep the second slot's header aligned
+    size = sizeof(SlotHeader) + ((size_t)Banks * sizeof(BankRecord));
+
+    return (size + 7) & ~(size_t)7;
+}
+
+static SlotHeader* slotHeader(const LedSnapshot* Snapshot, int Slot)
+{
+    return (SlotHeader*)(Snapshot->base + ((size_t)Slot * slotSize(Snapshot->banks)));
+}
+
+static BankRecord* slotRecords(const LedSnapshot* Snapshot, int Slot)
+{
+    return (BankRecord*)(slotHeader(Snapshot, Slot) + 1);
+}
+
+// FNV-1a over 16-bit words of the records, seeded with the sequence number
+static uint32_t checksum(const LedSnapshot* Snapshot, int Slot, uint32_t Sequence)
+{
+    const uint16_t* word;
+    size_t words;
+    size_t i;
+    uint32_t hash;
+
+    word = (const uint16_t*)slotRecords(Snapshot, Slot);
+    words = ((size_t)Snapshot->banks * sizeof(BankRecord)) / sizeof(uint16_t);
+    hash = 2166136261u ^ Sequence;
+
+    for (i = 0; i < words; i++)
+    {
+        hash = (hash ^ word[i]) * 16777619u;
+    }
+
+    return hash;
+}
+
+static bool isValidSlot(const LedSnapshot* Snapshot, int Slot)
+{
+    const SlotHeader* header;
+
+    header = slotHeader(Snapshot, Slot);
+
+    return ((SNAPSHOT_MAGIC == LED_ATOMIC_LOAD(&header->magic)) &&
+            (SNAPSHOT_VERSION == header->version) &&
+            (sizeof(BankRecord) == header->record_size) &&
+            (Snapshot->banks == header->banks) &&
+            (header->checksum == checksum(Snapshot, Slot, header->sequence)));
+}
+
+static bool matchesBuiltInMap(const BankRecord* Record)
+{
+    bool matches;
+    uint16_t bit;
+    uint8_t i;
+
+    matches = TRUE;
+
+    for (i = 0; i < 16; i++)
+    {
+        if (0 != (Record->flags & FLAG_INVERTED_INPUT))
+        {
+            bit = (uint16_t)(0x8000 >> i);
+        }
+        else
+        {
+            bit = (uint16_t)(1 << i);
+        }
+
+        if (bit != Record->bits[i])
+        {
+            matches = FALSE;
+        }
+    }
+
+    return matches;
+}
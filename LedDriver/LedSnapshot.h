@@ -0,0 +1,54 @@
+#ifndef _LED_SNAPSHOT_H_
+#define _LED_SNAPSHOT_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "stddef.h"
+#include "LedDriver.h"
+
+// Catch2 is a C++ test framework, to link a C library you need these tags
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A checkpoint file holding the register image, polarity and LED map of a
+// fixed number of banks, mapped into memory so that saving is a few stores
+// and restoring needs no file reads. The file holds two copies written in
+// turn, each with a sequence number and checksum, so a crash during a save
+// leaves the previous snapshot intact.
+typedef struct
+{
+    int fd;
+    uint8_t* base;
+    size_t size;
+    uint32_t banks;
+    int latest;
+} LedSnapshot;
+
+// Opens or creates the checkpoint at Path sized for Banks banks. Returns 1
+// when it holds a complete snapshot of that many banks, 0 when there is
+// nothing to restore (new, resized or corrupt file) and -1 on error.
+int LedSnapshot_Open(LedSnapshot* Snapshot, const char* Path, uint32_t Banks);
+
+void LedSnapshot_Close(LedSnapshot* Snapshot);
+
+// Records Banks[0..Count-1], where Count is the number given to Open. The
+// snapshot replaces the previous one once every bank has been written.
+int LedSnapshot_Save(LedSnapshot* Snapshot, LedDriver_Bank* const* Banks, uint32_t Count);
+
+// Waits until the last save has reached the disk
+int LedSnapshot_Sync(LedSnapshot* Snapshot);
+
+// Initialises Bank on Address with the state saved at Index using a single
+// register write, so LEDs that were on stay on. Map is the custom map the
+// bank used, or NULL for the built-in maps; -1 if it does not match the one
+// saved or there is no snapshot. Wear counters on Bank are detached, as by
+// any Adopt.
+int LedSnapshot_Restore(const LedSnapshot* Snapshot, uint32_t Index, LedDriver_Bank* Bank, uint16_t* Address, const LedDriver_Map* Map);
+
+// Catch2 is a C++ test framework, to link a C library you need these tags
+#ifdef __cplusplus
+}
+#endif
+
+#endif
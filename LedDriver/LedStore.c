@@ -0,0 +1,432 @@
+#include "LedStore.h"
+#include "string.h"
+
+#define TRUE 1
+#define FALSE 0
+
+#define COLUMN_ALIGNMENT 64
+#define BITS_PER_WORD 64
+
+#if defined(__GNUC__) || defined(__clang__)
+#define COUNT_BITS(Bits) ((uint32_t)__builtin_popcountll(Bits))
+#define LOWEST_BIT(Bits) ((uint32_t)__builtin_ctzll(Bits))
+#else
+#define COUNT_BITS(Bits) countBits(Bits)
+#define LOWEST_BIT(Bits) lowestBit(Bits)
+#endif
+
+static size_t alignColumn(size_t Bytes);
+static size_t wordCount(uint32_t Count);
+static uint32_t rangeEnd(const LedStore* Store, uint32_t First, uint32_t Count);
+static uint64_t wordMask(uint32_t Word, uint32_t First, uint32_t End);
+static void setBits(LedStore* Store, uint32_t Word, uint64_t Mask, bool On, uint32_t Now);
+#if !defined(__GNUC__) && !defined(__clang__)
+static uint32_t countBits(uint64_t Bits);
+static uint32_t lowestBit(uint64_t Bits);
+#endif
+
+size_t LedStore_Size(uint32_t Count)
+{
+    size_t words;
+
+    words = wordCount(Count);
+
+    return (2 * alignColumn(words * sizeof(uint64_t))) +
+           alignColumn((size_t)Count * sizeof(uint8_t)) +
+           alignColumn((size_t)Count * sizeof(uint32_t)) +
+           alignColumn((size_t)Count * sizeof(uint16_t));
+}
+
+int LedStore_Init(LedStore* Store, void* Memory, size_t Size, uint32_t Count)
+{
+    int result;
+    uint8_t* next;
+    size_t words;
+
+    result = -1;
+
+    if ((NULL != Store) && (NULL != Memory) && (0 == ((uintptr_t)Memory % COLUMN_ALIGNMENT)) && (Size >= LedStore_Size(Count)))
+    {
+        words = wordCount(Count);
+        next = (uint8_t*)Memory;
+
+        memset(Memory, 0, LedStore_Size(Count));
+
+        Store->count = Count;
+        Store->on = (uint64_t*)next;
+        next += alignColumn(words * sizeof(uint64_t));
+        Store->fault = (uint64_t*)next;
+        next += alignColumn(words * sizeof(uint64_t));
+        Store->brightness = next;
+        next += alignColumn((size_t)Count * sizeof(uint8_t));
+        Store->changed_at = (uint32_t*)next;
+        next += alignColumn((size_t)Count * sizeof(uint32_t));
+        Store->owner = (uint16_t*)next;
+
+        result = 0;
+    }
+
+    return result;
+}
+
+int LedStore_Set(LedStore* Store, uint32_t Index, bool On, uint32_t Now)
+{
+    return LedStore_SetRange(Store, Index, 1, On, Now);
+}
+
+int LedStore_SetRange(LedStore* Store, uint32_t First, uint32_t Count, bool On, uint32_t Now)
+{
+    int result;
+    uint32_t end;
+    uint32_t word;
+
+    result = -1;
+
+    if ((NULL != Store) && (First < Store->count) && (Count <= (Store->count - First)))
+    {
+        end = First + Count;
+
+        if (First < end)
+        {
+            // Bounded by the last word's index, as word * 64 wraps for ranges
+            // ending in the last word of a store of nearly 2^32 LEDs
+            for (word = First / BITS_PER_WORD; word <= ((end - 1) / BITS_PER_WORD); word++)
+            {
+                setBits(Store, word, wordMask(word, First, end), On, Now);
+            }
+        }
+
+        result = 0;
+    }
+
+    return result;
+}
+
+bool LedStore_IsOn(const LedStore* Store, uint32_t Index)
+{
+    bool on;
+
+    on = FALSE;
+
+    if ((NULL != Store) && (Index < Store->count))
+    {
+        on = (0 != (Store->on[Index / BITS_PER_WORD] & (1ull << (Index % BITS_PER_WORD))));
+    }
+
+    return on;
+}
+
+int LedStore_SetFault(LedStore* Store, uint32_t Index, bool Faulted)
+{
+    int result;
+    uint64_t bit;
+
+    result = -1;
+
+    if ((NULL != Store) && (Index < Store->count))
+    {
+        bit = 1ull << (Index % BITS_PER_WORD);
+
+        if (TRUE == Faulted)
+        {
+            Store->fault[Index / BITS_PER_WORD] |= bit;
+        }
+        else
+        {
+            Store->fault[Index / BITS_PER_WORD] &= ~bit;
+        }
+
+        result = 0;
+    }
+
+    return result;
+}
+
+bool LedStore_IsFaulted(const LedStore* Store, uint32_t Index)
+{
+    bool faulted;
+
+    faulted = FALSE;
+
+    if ((NULL != Store) && (Index < Store->count))
+    {
+        faulted = (0 != (Store->fault[Index / BITS_PER_WORD] & (1ull << (Index % BITS_PER_WORD))));
+    }
+
+    return faulted;
+}
+
+int LedStore_SetBrightness(LedStore* Store, uint32_t Index, uint8_t Brightness)
+{
+    int result;
+
+    result = -1;
+
+    if ((NULL != Store) && (Index < Store->count))
+    {
+        Store->brightness[Index] = Brightness;
+
+        result = 0;
+    }
+
+    return result;
+}
+
+int LedStore_SetOwner(LedStore* Store, uint32_t Index, uint16_t Owner)
+{
+    int result;
+
+    result = -1;
+
+    if ((NULL != Store) && (Index < Store->count))
+    {
+        Store->owner[Index] = Owner;
+
+        result = 0;
+    }
+
+    return result;
+}
+
+uint32_t LedStore_CountOn(const LedStore* Store, uint32_t First, uint32_t Count)
+{
+    uint32_t found;
+    uint32_t end;
+    uint32_t word;
+
+    found = 0;
+    end = rangeEnd(Store, First, Count);
+
+    if (First < end)
+    {
+        for (word = First / BITS_PER_WORD; word <= ((end - 1) / BITS_PER_WORD); word++)
+        {
+            found += COUNT_BITS(Store->on[word] & wordMask(word, First, end));
+        }
+    }
+
+    return found;
+}
+
+uint32_t LedStore_CountLitFaulted(const LedStore* Store, uint32_t First, uint32_t Count)
+{
+    uint32_t found;
+    uint32_t end;
+    uint32_t word;
+
+    found = 0;
+    end = rangeEnd(Store, First, Count);
+
+    if (First < end)
+    {
+        for (word = First / BITS_PER_WORD; word <= ((end - 1) / BITS_PER_WORD); word++)
+        {
+            found += COUNT_BITS(Store->on[word] & Store->fault[word] & wordMask(word, First, end));
+        }
+    }
+
+    return found;
+}
+
+uint32_t LedStore_FindLitFaulted(const LedStore* Store, uint32_t First, uint32_t Count, uint32_t* Found, uint32_t Max)
+{
+    uint32_t found;
+    uint32_t end;
+    uint32_t word;
+    uint64_t bits;
+
+    found = 0;
+    end = rangeEnd(Store, First, Count);
+
+    if ((First < end) && (NULL != Found))
+    {
+        for (word = First / BITS_PER_WORD; (word <= ((end - 1) / BITS_PER_WORD)) && (found < Max); word++)
+        {
+            bits = Store->on[word] & Store->fault[word] & wordMask(word, First, end);
+
+            while ((0 != bits) && (found < Max))
+            {
+                Found[found] = (word * BITS_PER_WORD) + LOWEST_BIT(bits);
+                found++;
+                bits &= bits - 1;
+            }
+        }
+    }
+
+    return found;
+}
+
+uint32_t LedStore_CountBrightnessAtLeast(const LedStore* Store, uint32_t First, uint32_t Count, uint8_t Level)
+{
+    const uint8_t* brightness;
+    uint32_t found;
+    uint32_t end;
+    uint32_t i;
+
+    found = 0;
+    end = rangeEnd(Store, First, Count);
+
+    if (First < end)
+    {
+        brightness = Store->brightness;
+
+        for (i = First; i < end; i++)
+        {
+            found += (brightness[i] >= Level);
+        }
+    }
+
+    return found;
+}
+
+uint32_t LedStore_CountOwnedBy(const LedStore* Store, uint32_t First, uint32_t Count, uint16_t Owner)
+{
+    const uint16_t* owner;
+    uint32_t found;
+    uint32_t end;
+    uint32_t i;
+
+    found = 0;
+    end = rangeEnd(Store, First, Count);
+
+    if (First < end)
+    {
+        owner = Store->owner;
+
+        for (i = First; i < end; i++)
+        {
+            found += (owner[i] == Owner);
+        }
+    }
+
+    return found;
+}
+
+uint32_t LedStore_CountChangedSince(const LedStore* Store, uint32_t First, uint32_t Count, uint32_t Since, uint32_t Now)
+{
+    const uint32_t* changedAt;
+    uint32_t window;
+    uint32_t found;
+    uint32_t end;
+    uint32_t i;
+
+    found = 0;
+    end = rangeEnd(Store, First, Count);
+
+    if (First < end)
+    {
+        changedAt = Store->changed_at;
+        window = Now - Since;
+
+        // Age relative to Now, so the comparison survives the clock wrapping
+        for (i = First; i < end; i++)
+        {
+            found += ((uint32_t)(Now - changedAt[i]) <= window);
+        }
+    }
+
+    return found;
+}
+
+static size_t alignColumn(size_t Bytes)
+{
+    return (Bytes + COLUMN_ALIGNMENT - 1) & ~(size_t)(COLUMN_ALIGNMENT - 1);
+}
+
+// In 64 bits, as Count + 63 overflows 32 for the largest stores
+static size_t wordCount(uint32_t Count)
+{
+    return (size_t)(((uint64_t)Count + BITS_PER_WORD - 1) / BITS_PER_WORD);
+}
+
+// End of [First, First + Count) clipped to the store; First when the store
+// is missing so that the range is empty
+static uint32_t rangeEnd(const LedStore* Store, uint32_t First, uint32_t Count)
+{
+    uint32_t end;
+
+    end = First;
+
+    if ((NULL != Store) && (First < Store->count))
+    {
+        end = Store->count;
+
+        if (Count < (Store->count - First))
+        {
+            end = First + Count;
+        }
+    }
+
+    return end;
+}
+
+// Bits of Word that fall inside [First, End)
+static uint64_t wordMask(uint32_t Word, uint32_t First, uint32_t End)
+{
+    uint64_t mask;
+    uint32_t base;
+
+    mask = ~0ull;
+    base = Word * BITS_PER_WORD;
+
+    if (First > base)
+    {
+        mask &= ~0ull << (First - base);
+    }
+
+    if ((End - base) < BITS_PER_WORD)
+    {
+        mask &= (1ull << (End - base)) - 1;
+    }
+
+    return mask;
+}
+
+static void setBits(LedStore* Store, uint32_t Word, uint64_t Mask, bool On, uint32_t Now)
+{
+    uint64_t changed;
+
+    if (TRUE == On)
+    {
+        changed = ~Store->on[Word] & Mask;
+        Store->on[Word] |= Mask;
+    }
+    else
+    {
+        changed = Store->on[Word] & Mask;
+        Store->on[Word] &= ~Mask;
+    }
+
+    while (0 != changed)
+    {
+        Store->changed_at[(Word * BITS_PER_WORD) + LOWEST_BIT(changed)] = Now;
+        changed &= changed - 1;
+    }
+}
+
+#if !defined(__GNUC__) && !defined(__clang__)
+static uint32_t countBits(uint64_t Bits)
+{
+    Bits = Bits - ((Bits >> 1) & 0x5555555555555555ULL);
+    Bits = (Bits & 0x3333333333333333ULL) + ((Bits >> 2) & 0x3333333333333333ULL);
+    Bits = (Bits + (Bits >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+
+    return (uint32_t)((Bits * 0x0101010101010101ULL) >> 56);
+}
+
+// Bits must not be zero
+static uint32_t lowestBit(uint64_t Bits)
+{
+    uint32_t bit;
+
+    bit = 0;
+
+    while (0 == (Bits & 1))
+    {
+        Bits >>= 1;
+        bit++;
+    }
+
+    return bit;
+}
+#endif
@@ -0,0 +1,75 @@
+#ifndef _LED_STORE_H_
+#define _LED_STORE_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "stddef.h"
+
+// Catch2 is a C++ test framework, to link a C library you need these tags
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// State and metadata for very large LED arrays, kept as one packed column
+// per field rather than one struct per LED. On/off and fault are bit
+// columns like a bank's status word; brightness, last change time and owner
+// are plain arrays. A query only reads the columns it asks about, and its
+// inner loops are written so the compiler can vectorise them. LEDs are
+// numbered from 0; ranges are [First, First + Count).
+typedef struct
+{
+    uint32_t count;
+    uint64_t* on;
+    uint64_t* fault;
+    uint8_t* brightness;
+    uint32_t* changed_at;
+    uint16_t* owner;
+} LedStore;
+
+// Bytes of storage LedStore_Init needs for Count LEDs
+size_t LedStore_Size(uint32_t Count);
+
+// Lays the columns out in Memory, which the caller owns and which must be
+// at least LedStore_Size(Count) bytes and 64-byte aligned. Every LED starts
+// off, unfaulted, at brightness 0, owner 0 and changed at time 0.
+int LedStore_Init(LedStore* Store, void* Memory, size_t Size, uint32_t Count);
+
+// Switches an LED, recording Now as its last change time if it changed
+int LedStore_Set(LedStore* Store, uint32_t Index, bool On, uint32_t Now);
+
+// Switches a whole range a word at a time. Change times are updated for
+// the LEDs that changed.
+int LedStore_SetRange(LedStore* Store, uint32_t First, uint32_t Count, bool On, uint32_t Now);
+
+bool LedStore_IsOn(const LedStore* Store, uint32_t Index);
+
+int LedStore_SetFault(LedStore* Store, uint32_t Index, bool Faulted);
+
+bool LedStore_IsFaulted(const LedStore* Store, uint32_t Index);
+
+int LedStore_SetBrightness(LedStore* Store, uint32_t Index, uint8_t Brightness);
+
+int LedStore_SetOwner(LedStore* Store, uint32_t Index, uint16_t Owner);
+
+// Range queries. Out-of-range parts of a range are ignored.
+uint32_t LedStore_CountOn(const LedStore* Store, uint32_t First, uint32_t Count);
+
+uint32_t LedStore_CountLitFaulted(const LedStore* Store, uint32_t First, uint32_t Count);
+
+// Writes up to Max indices of lit, faulted LEDs to Found and returns how
+// many it wrote
+uint32_t LedStore_FindLitFaulted(const LedStore* Store, uint32_t First, uint32_t Count, uint32_t* Found, uint32_t Max);
+
+uint32_t LedStore_CountBrightnessAtLeast(const LedStore* Store, uint32_t First, uint32_t Count, uint8_t Level);
+
+uint32_t LedStore_CountOwnedBy(const LedStore* Store, uint32_t First, uint32_t Count, uint16_t Owner);
+
+// LEDs whose last change was at or after Since; times may wrap
+uint32_t LedStore_CountChangedSince(const LedStore* Store, uint32_t First, uint32_t Count, uint32_t Since, uint32_t Now);
+
+// Catch2 is a C++ test framework, to link a C library you need these tags
+#ifdef __cplusplus
+}
+#endif
+
+#endif
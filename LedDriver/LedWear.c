@@ -0,0 +1,247 @@
+#include "LedWear.h"
+#include "LedAtomic.h"
+#include "stddef.h"
+
+#define TRUE 1
+#define FALSE 0
+
+#if defined(__GNUC__) || defined(__clang__)
+#define LOWEST_BIT(Bits) ((uint32_t)__builtin_ctz(Bits))
+#else
+#define LOWEST_BIT(Bits) lowestBit(Bits)
+#endif
+
+static uint32_t readClock(const LedWear_Counters* Counters);
+static bool isRunning(const LedWear_Counters* Counters);
+static uint16_t litBits(const LedDriver_Bank* Bank);
+#if !defined(__GNUC__) && !defined(__clang__)
+static uint32_t lowestBit(uint32_t Bits);
+#endif
+
+int LedWear_Attach(LedWear_Counters* Counters, LedDriver_Bank* Bank, const volatile uint32_t* Clock)
+{
+    int result;
+    uint32_t now;
+    uint32_t output;
+    uint16_t lit;
+
+    result = -1;
+
+    if ((NULL != Counters) && (NULL != Bank) && (NULL != Bank->address) && (NULL != Clock))
+    {
+        now = *Clock;
+
+        Counters->clock = Clock;
+        Counters->bank = Bank;
+        Counters->lit_bits = litBits(Bank);
+        lit = 0;
+
+        // The map is a permutation, so each register bit drives one LED
+        for (output = 0; output < LED_WEAR_OUTPUTS; output++)
+        {
+            Counters->led[LOWEST_BIT(Bank->map->bits[output])] = (uint8_t)output;
+
+            if (0 != (Counters->lit_bits & Bank->map->bits[output]))
+            {
+                lit |= (uint16_t)(1u << output);
+            }
+
+            Counters->on_since[output] = now;
+            Counters->on_time[output] = 0;
+            Counters->toggles[output] = 0;
+        }
+
+        Counters->lit = lit;
+        Bank->wear = Counters;
+
+        result = 0;
+    }
+
+    return result;
+}
+
+int LedWear_Detach(LedDriver_Bank* Bank)
+{
+    int result;
+
+    result = -1;
+
+    if ((NULL != Bank) && (NULL != Bank->wear))
+    {
+        LedWear_Sync(Bank->wear);
+
+        // Nothing is left running, so Export adds no time from here on
+        Bank->wear->lit = 0;
+        Bank->wear->lit_bits = 0;
+        Bank->wear->bank = NULL;
+
+        LED_ATOMIC_STORE_RELAXED(&Bank->wear, NULL);
+
+        result = 0;
+    }
+
+    return result;
+}
+
+void LedWear_Record(const LedDriver_Bank* Bank)
+{
+    LedWear_Counters* counters;
+    uint16_t bits;
+    uint32_t now;
+    uint32_t changed;
+    uint32_t bit;
+    uint32_t output;
+
+    counters = Bank->wear;
+    bits = litBits(Bank);
+    changed = (uint32_t)(bits ^ counters->lit_bits);
+
+    if (0 != changed)
+    {
+        now = readClock(counters);
+
+        // One pass per register bit that changed, lowest first, each
+        // counted against the LED it drives
+        while (0 != changed)
+        {
+            bit = LOWEST_BIT(changed);
+            changed &= changed - 1;
+            output = counters->led[bit];
+
+            counters->toggles[output]++;
+            counters->lit ^= (uint16_t)(1u << output);
+
+            if (0 != (bits & (1u << bit)))
+            {
+                counters->on_since[output] = now;
+            }
+            else
+            {
+                counters->on_time[output] += now - counters->on_since[output];
+            }
+        }
+
+        counters->lit_bits = bits;
+    }
+}
+
+void LedWear_Sync(LedWear_Counters* Counters)
+{
+    uint32_t now;
+    uint32_t lit;
+    uint32_t output;
+
+    if ((NULL != Counters) && (TRUE == isRunning(Counters)))
+    {
+        now = readClock(Counters);
+        lit = Counters->lit;
+
+        while (0 != lit)
+        {
+            output = LOWEST_BIT(lit);
+            lit &= lit - 1;
+
+            Counters->on_time[output] += now - Counters->on_since[output];
+            Counters->on_since[output] = now;
+        }
+    }
+}
+
+int LedWear_Export(const LedWear_Counters* Counters, uint32_t Count, uint64_t* OnTime, uint32_t* Toggles)
+{
+    int result;
+    const LedWear_Counters* counters;
+    uint64_t* onTime;
+    uint32_t now;
+    uint32_t lit;
+    uint32_t bank;
+    uint32_t output;
+
+    result = -1;
+
+    if (NULL != Counters)
+    {
+        for (bank = 0; bank < Count; bank++)
+        {
+            counters = &Counters[bank];
+
+            if (NULL != OnTime)
+            {
+                onTime = &OnTime[(size_t)bank * LED_WEAR_OUTPUTS];
+
+                for (output = 0; output < LED_WEAR_OUTPUTS; output++)
+                {
+                    onTime[output] = counters->on_time[output];
+                }
+
+                // Only outputs lit right now have time still running
+                now = readClock(counters);
+                lit = (TRUE == isRunning(counters)) ? counters->lit : 0;
+
+                while (0 != lit)
+                {
+                    output = LOWEST_BIT(lit);
+                    lit &= lit - 1;
+
+                    onTime[output] += now - counters->on_since[output];
+                }
+            }
+
+            if (NULL != Toggles)
+            {
+                for (output = 0; output < LED_WEAR_OUTPUTS; output++)
+                {
+                    Toggles[((size_t)bank * LED_WEAR_OUTPUTS) + output] = counters->toggles[output];
+                }
+            }
+        }
+
+        result = 0;
+    }
+
+    return result;
+}
+
+static uint16_t litBits(const LedDriver_Bank* Bank)
+{
+    return (TRUE == Bank->inverted_output) ? (uint16_t)~Bank->status : Bank->status;
+}
+
+// Counters that were never attached have no clock; their time stands at zero
+static uint32_t readClock(const LedWear_Counters* Counters)
+{
+    uint32_t now;
+
+    now = 0;
+
+    if (NULL != Counters->clock)
+    {
+        now = *Counters->clock;
+    }
+
+    return now;
+}
+
+// Init and Adopt drop the bank's pointer without touching the counters
+static bool isRunning(const LedWear_Counters* Counters)
+{
+    return ((NULL != Counters->bank) && (Counters == LED_ATOMIC_LOAD_RELAXED(&Counters->bank->wear)));
+}
+
+#if !defined(__GNUC__) && !defined(__clang__)
+// Bits must not be zero
+static uint32_t lowestBit(uint32_t Bits)
+{
+    uint32_t bit;
+
+    bit = 0;
+
+    while (0 == (Bits & 1))
+    {
+        Bits >>= 1;
+        bit++;
+    }
+
+    return bit;
+}
+#endif
@@ -0,0 +1,66 @@
+#ifndef _LED_WEAR_H_
+#define _LED_WEAR_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "LedDriver.h"
+
+// Catch2 is a C++ test framework, to link a C library you need these tags
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LED_WEAR_OUTPUTS 16
+
+// Cumulative on-time and toggle count of each output of one bank, kept up to
+// date on every register write of a bank they are attached to; a bank
+// without counters pays one pointer test per write. Counters
+// are indexed by LED number through the bank's map, entry n-1 for LED n,
+// whatever register bit drives it and whatever the polarity. On-time is in
+// ticks of the counter Clock points at, typically a free-running timer
+// incremented by an interrupt; it may wrap, but an output lit for 2^32 ticks
+// or more must be folded in with LedWear_Sync at least once per wrap. Each
+// write costs a compare plus work per output that changed, never per output.
+typedef struct LedWear_Counters
+{
+    const volatile uint32_t* clock;
+    const LedDriver_Bank* bank;  // bank attached to, NULL once detached
+    uint16_t lit;               // LEDs lit, bit n-1 for LED n
+    uint16_t lit_bits;          // register bits of those LEDs as last written
+    uint8_t led[LED_WEAR_OUTPUTS];  // LED index of each register bit
+    uint32_t on_since[LED_WEAR_OUTPUTS];
+    uint64_t on_time[LED_WEAR_OUTPUTS];
+    uint32_t toggles[LED_WEAR_OUTPUTS];
+} LedWear_Counters;
+
+// Zeroes Counters and starts counting Bank's writes from its current state.
+// Init and Adopt detach the counters, because the bank storage they are
+// given may never have been initialised: attach again after re-initialising
+// a bank, restoring it from a snapshot or acquiring it from the pool. The
+// bank must outlive the counters' attachment.
+int LedWear_Attach(LedWear_Counters* Counters, LedDriver_Bank* Bank, const volatile uint32_t* Clock);
+
+// Folds the running on-time in and stops the counters, which keep their
+// totals. LedPool_Release does this itself. Counters detached by Init or
+// Adopt stop too, but lose the on-time since the bank's last write or Sync.
+int LedWear_Detach(LedDriver_Bank* Bank);
+
+// Called by the driver after each register write of a bank with counters
+void LedWear_Record(const LedDriver_Bank* Bank);
+
+// Adds the time lit outputs have been on so far to their totals; detached
+// counters have none running
+void LedWear_Sync(LedWear_Counters* Counters);
+
+// Bulk export of Count banks' totals, 16 per bank in LED order,
+// into OnTime[Count * 16] and Toggles[Count * 16]; either may be NULL.
+// On-time includes outputs still lit, up to now, on banks the counters are
+// still attached to. Zeroed counters that were never attached export as zero.
+int LedWear_Export(const LedWear_Counters* Counters, uint32_t Count, uint64_t* OnTime, uint32_t* Toggles);
+
+// Catch2 is a C++ test framework, to link a C library you need these tags
+#ifdef __cplusplus
+}
+#endif
+
+#endif
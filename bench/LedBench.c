@@ -0,0 +1,172 @@
+#include "LedDriver.h"
+#include "stdint.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "time.h"
+
+/***********************************************************************
+ * LED Driver Benchmark
+ *
+ * Built once per driver variant (library, inline, lto) so the cost of a
+ * call can be compared. A compiler barrier after every call keeps each
+ * register write in place; without it the inline build would be free to
+ * merge a whole loop into one store, which real hardware would not allow.
+ *
+ * usage: LedDriver_bench [iterations]
+ *
+************************************************************************/
+
+#ifndef LED_BENCH_VARIANT
+#define LED_BENCH_VARIANT "library"
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BARRIER() __asm__ __volatile__("" ::: "memory")
+#else
+#define BARRIER()
+#endif
+
+static uint16_t VirtualLEDs;
+static volatile uint32_t sink;
+
+void RuntimeError(const char * m, int p, const char * f, int l)
+{
+    (void)m;
+    (void)p;
+    (void)f;
+    (void)l;
+}
+
+static double nowSeconds(void)
+{
+    struct timespec ts;
+
+    timespec_get(&ts, TIME_UTC);
+
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+}
+
+static void report(const char* name, uint64_t operations, double seconds)
+{
+    printf("%-8s %-24s %8.3f ns/op %10.1f Mops/s\n",
+           LED_BENCH_VARIANT, name,
+           (seconds * 1e9) / (double)operations,
+           ((double)operations / seconds) / 1e6);
+}
+
+static void benchBankToggle(uint64_t iterations)
+{
+    LedDriver_Bank bank;
+    double start;
+    uint64_t i;
+
+    LedDriver_BankInit(&bank, &VirtualLEDs, false, false);
+
+    start = nowSeconds();
+
+    for (i = 0; i < iterations; i++)
+    {
+        int16_t led = (int16_t)((i & 15) + 1);
+
+        LedDriver_BankTurnOn(&bank, led);
+        BARRIER();
+        LedDriver_BankTurnOff(&bank, led);
+        BARRIER();
+    }
+
+    report("bank on/off", 2 * iterations, nowSeconds() - start);
+}
+
+static void benchBankInverted(uint64_t iterations)
+{
+    LedDriver_Bank bank;
+    double start;
+    uint64_t i;
+
+    LedDriver_BankInit(&bank, &VirtualLEDs, true, true);
+
+    start = nowSeconds();
+
+    for (i = 0; i < iterations; i++)
+    {
+        int16_t led = (int16_t)((i & 15) + 1);
+
+        LedDriver_BankTurnOn(&bank, led);
+        BARRIER();
+        LedDriver_BankTurnOff(&bank, led);
+        BARRIER();
+    }
+
+    report("bank on/off inverted", 2 * iterations, nowSeconds() - start);
+}
+
+static void benchBankQuery(uint64_t iterations)
+{
+    LedDriver_Bank bank;
+    uint32_t lit;
+    double start;
+    uint64_t i;
+
+    LedDriver_BankInit(&bank, &VirtualLEDs, false, false);
+    LedDriver_BankTurnOn(&bank, 3);
+
+    lit = 0;
+    start = nowSeconds();
+
+    for (i = 0; i < iterations; i++)
+    {
+        lit += LedDriver_BankIsOn(&bank, (int16_t)((i & 15) + 1));
+        BARRIER();
+    }
+
+    report("bank is-on", iterations, nowSeconds() - start);
+
+    sink = lit;
+}
+
+static void benchDefaultToggle(uint64_t iterations)
+{
+    double start;
+    uint64_t i;
+
+    LedDriver_Init(&VirtualLEDs, false, false);
+
+    start = nowSeconds();
+
+    for (i = 0; i < iterations; i++)
+    {
+        int16_t led = (int16_t)((i & 15) + 1);
+
+        LedDriver_TurnOn(led);
+        BARRIER();
+        LedDriver_TurnOff(led);
+        BARRIER();
+    }
+
+    report("default on/off", 2 * iterations, nowSeconds() - start);
+}
+
+int main(int argc, char** argv)
+{
+    uint64_t iterations = 20000000;
+
+    if (argc > 1)
+    {
+        iterations = strtoull(argv[1], NULL, 10);
+    }
+
+    if (0 == iterations)
+    {
+        printf("usage: %s [iterations]\n", argv[0]);
+        return 2;
+    }
+
+    benchBankToggle(iterations);
+    benchBankInverted(iterations);
+    benchBankQuery(iterations);
+    benchDefaultToggle(iterations);
+
+    sink = VirtualLEDs;
+
+    return 0;
+}
@@ -0,0 +1,185 @@
+#include "LedBus.h"
+#include "LedCompositor.h"
+#include "LedDriver.h"
+#include "LedRateLimit.h"
+#include "stdint.h"
+#include "stdio.h"
+#include "stdlib.h"
+
+/***********************************************************************
+ * LED Bus Benchmark
+ *
+ * Plays the same animation through a real-time emulated bus with four
+ * update strategies: one driver call per LED, one masked update per
+ * frame, the compositor (writes only changed frames) and the rate
+ * limiter. Register writes cost what they would on a slow SPI or I2C
+ * bus, so the wall time per frame shows what each strategy saves.
+ *
+ * usage: LedDriver_bench_bus [frames] [latency ns] [bytes per second] [jitter ns]
+ *
+************************************************************************/
+
+static uint16_t busRegister;
+
+void RuntimeError(const char * m, int p, const char * f, int l)
+{
+    (void)m;
+    (void)p;
+    (void)f;
+    (void)l;
+}
+
+// A four-LED chaser that moves every fourth frame
+static uint16_t framePattern(uint32_t frame)
+{
+    uint32_t shift = (frame / 4) & 15;
+
+    return (uint16_t)((0x000Fu << shift) | (0x000Fu >> (16 - shift)));
+}
+
+static void perLed(LedDriver_Bank* bank, uint32_t frame)
+{
+    uint16_t pattern = framePattern(frame);
+    int16_t led;
+
+    for (led = 1; led <= 16; led++)
+    {
+        if (0 != (pattern & (1u << (led - 1))))
+        {
+            LedDriver_BankTurnOn(bank, led);
+        }
+        else
+        {
+            LedDriver_BankTurnOff(bank, led);
+        }
+    }
+}
+
+static void masked(LedDriver_Bank* bank, uint32_t frame)
+{
+    uint16_t pattern = framePattern(frame);
+
+    LedDriver_BankUpdate(bank, pattern, (uint16_t)~pattern);
+}
+
+static void report(const char* name, LedBus* bus, uint32_t frames, uint64_t elapsed)
+{
+    LedBus_Stats stats;
+
+    LedBus_GetStats(bus, &stats);
+
+    printf("%-12s %9.0f ns/frame %8llu writes %8llu redundant %6.1f %% busy\n",
+           name,
+           (double)elapsed / (double)frames,
+           (unsigned long long)stats.writes,
+           (unsigned long long)stats.redundant,
+           (100.0 * (double)stats.busy_ns) / (double)elapsed);
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t frames = 2000;
+    LedBus_Config config;
+    LedBus bus;
+    LedDriver_Bank bank;
+    LedCompositor compositor;
+    LedRateLimit limit;
+    uint64_t start;
+    uint32_t frame;
+    int layer;
+
+    config.latency_ns = 2000;
+    config.bytes_per_second = 1000000;
+    config.frame_bytes = 2;
+    config.jitter_ns = 500;
+    config.seed = 1;
+    config.real_time = true;
+
+    if (argc > 1)
+    {
+        frames = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+
+    if (argc > 2)
+    {
+        config.latency_ns = (uint32_t)strtoul(argv[2], NULL, 10);
+    }
+
+    if (argc > 3)
+    {
+        config.bytes_per_second = (uint32_t)strtoul(argv[3], NULL, 10);
+    }
+
+    if (argc > 4)
+    {
+        config.jitter_ns = (uint32_t)strtoul(argv[4], NULL, 10);
+    }
+
+    if (0 == frames)
+    {
+        printf("usage: %s [frames] [latency ns] [bytes per second] [jitter ns]\n", argv[0]);
+        return 2;
+    }
+
+    LedBus_Init(&bus, &config, &busRegister, 1);
+    LedDriver_BankInit(&bank, &busRegister, false, false);
+    LedBus_Select(&bus);
+
+    printf("bus: %u ns latency, %u B/s, %u ns jitter, %u frames\n",
+           config.latency_ns, config.bytes_per_second, config.jitter_ns, frames);
+
+    LedBus_ResetStats(&bus);
+    start = LedBus_Now();
+
+    for (frame = 0; frame < frames; frame++)
+    {
+        perLed(&bank, frame);
+    }
+
+    report("per-LED", &bus, frames, LedBus_Now() - start);
+
+    LedBus_ResetStats(&bus);
+    start = LedBus_Now();
+
+    for (frame = 0; frame < frames; frame++)
+    {
+        masked(&bank, frame);
+    }
+
+    report("masked", &bus, frames, LedBus_Now() - start);
+
+    LedCompositor_Init(&compositor, &bank);
+    layer = LedCompositor_AddLayer(&compositor, 0);
+
+    LedBus_ResetStats(&bus);
+    start = LedBus_Now();
+
+    for (frame = 0; frame < frames; frame++)
+    {
+        LedCompositor_Set(&compositor, layer, 0xFFFF, false);
+        LedCompositor_Set(&compositor, layer, framePattern(frame), true);
+        LedCompositor_Flush(&compositor);
+    }
+
+    report("compositor", &bus, frames, LedBus_Now() - start);
+
+    // Frames are the ticks: at most one write every second frame
+    LedRateLimit_Init(&limit, &bank, 2, 0);
+
+    LedBus_ResetStats(&bus);
+    start = LedBus_Now();
+
+    for (frame = 0; frame < frames; frame++)
+    {
+        perLed(&bank, frame);
+        LedRateLimit_Service(&limit, frame);
+    }
+
+    LedRateLimit_Detach(&limit);
+
+    report("rate limit", &bus, frames, LedBus_Now() - start);
+
+    LedBus_Select(NULL);
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include "LedCommand.h"
+#include "stdint.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "time.h"
+
+/***********************************************************************
+ * LED Command Benchmark
+ *
+ * Parses and applies a script of typical operator command lines and
+ * reports the throughput in MB/s and batches per second.
+ *
+ * usage: LedDriver_bench_command [lines] [passes]
+ *
+************************************************************************/
+
+void RuntimeError(const char * m, int p, const char * f, int l)
+{
+    (void)m;
+    (void)p;
+    (void)f;
+    (void)l;
+}
+
+static double nowSeconds(void)
+{
+    struct timespec ts;
+
+    timespec_get(&ts, TIME_UTC);
+
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+}
+
+static const char* const sampleLines[] =
+{
+    "on 1-8,12; off 3\n",
+    "all off\n",
+    "on 1,3,5,7,9,11,13,15\n",
+    "off 2-4, 10 - 12; on 16\n",
+    "all on; off 1-16; on 7\n",
+    "on 4\n",
+};
+
+#define SAMPLES (sizeof(sampleLines) / sizeof(sampleLines[0]))
+
+int main(int argc, char** argv)
+{
+    uint32_t lines = 100000;
+    uint32_t passes = 20;
+    LedDriver_Bank bank;
+    uint16_t LEDs;
+    char* script;
+    size_t length;
+    size_t used;
+    double elapsed;
+    double start;
+    uint32_t failed;
+    uint32_t i;
+
+    if (argc > 1)
+    {
+        lines = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+
+    if (argc > 2)
+    {
+        passes = (uint32_t)strtoul(argv[2], NULL, 10);
+    }
+
+    if ((0 == lines) || (0 == passes))
+    {
+        printf("usage: %s [lines] [passes]\n", argv[0]);
+        return 2;
+    }
+
+    script = (char*)malloc((size_t)lines * 32);
+
+    if (NULL == script)
+    {
+        printf("out of memory\n");
+        return 1;
+    }
+
+    length = 0;
+
+    for (i = 0; i < lines; i++)
+    {
+        used = strlen(sampleLines[i % SAMPLES]);
+        memcpy(&script[length], sampleLines[i % SAMPLES], used);
+        length += used;
+    }
+
+    LedDriver_BankInit(&bank, &LEDs, false, false);
+
+    failed = 0;
+    start = nowSeconds();
+
+    for (i = 0; i < passes; i++)
+    {
+        failed += (uint32_t)LedCommand_Run(&bank, script, length);
+    }
+
+    elapsed = nowSeconds() - start;
+
+    printf("%u lines, %zu bytes, %u passes, %u failed\n", lines, length, passes, failed);
+    printf("parse + apply  %8.1f MB/s  %8.2f M batches/s  (final state 0x%04X)\n",
+           ((double)length * passes) / elapsed / 1e6,
+           ((double)lines * passes) / elapsed / 1e6,
+           LEDs);
+
+    free(script);
+
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include "LedDriver.hpp"
+#include "stdint.h"
+#include "stdio.h"
+#include "stdlib.h"
+
+#include <chrono>
+
+/***********************************************************************
+ * LED C++ Wrapper Benchmark
+ *
+ * Times the same loops written against the inline C API and through the
+ * C++ wrapper. The wrapper is meant to cost nothing, so each pair should
+ * report the same time per operation.
+ *
+ * usage: LedDriver_bench_cxx [iterations]
+ *
+************************************************************************/
+
+#define BARRIER() __asm__ __volatile__("" ::: "memory")
+
+static uint16_t VirtualLEDs;
+
+extern "C" void RuntimeError(const char * m, int p, const char * f, int l)
+{
+    (void)m;
+    (void)p;
+    (void)f;
+    (void)l;
+}
+
+template <typename Body>
+static void time(const char* name, uint64_t iterations, uint64_t operationsPerIteration, Body body)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        body(i);
+        BARRIER();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%-28s %8.3f ns/op\n", name, (seconds * 1e9) / (double)(iterations * operationsPerIteration));
+}
+
+int main(int argc, char** argv)
+{
+    uint64_t iterations = 20000000;
+    LedDriver_Bank bank;
+    uint32_t lit = 0;
+
+    if (argc > 1)
+    {
+        iterations = strtoull(argv[1], NULL, 10);
+    }
+
+    if (0 == iterations)
+    {
+        printf("usage: %s [iterations]\n", argv[0]);
+        return 2;
+    }
+
+    auto created = led::LedBank::create(&VirtualLEDs);
+
+    if (false == created.has_value())
+    {
+        return 1;
+    }
+
+    led::LedBank handle = std::move(created).value();
+
+    LedDriver_BankInit(&bank, &VirtualLEDs, false, false);
+
+    time("C   on/off", iterations, 2, [&](uint64_t i)
+    {
+        int16_t led = (int16_t)((i & 15) + 1);
+
+        LedDriver_BankTurnOn(&bank, led);
+        BARRIER();
+        LedDriver_BankTurnOff(&bank, led);
+    });
+
+    time("C++ on/off", iterations, 2, [&](uint64_t i)
+    {
+        int16_t led = (int16_t)((i & 15) + 1);
+
+        (void)handle.turnOn(led);
+        BARRIER();
+        (void)handle.turnOff(led);
+    });
+
+    time("C   masked update", iterations, 1, [&](uint64_t i)
+    {
+        LedDriver_BankUpdate(&bank, (uint16_t)(1u << (i & 15)), (uint16_t)(0x8000u >> (i & 15)));
+    });
+
+    time("C++ transaction", iterations, 1, [&](uint64_t i)
+    {
+        led::LedTransaction transaction(handle);
+
+        (void)transaction.turnOff((int16_t)(16 - (i & 15)));
+        (void)transaction.turnOn((int16_t)((i & 15) + 1));
+    });
+
+    time("C   is-on", iterations, 1, [&](uint64_t i)
+    {
+        lit += LedDriver_BankIsOn(&bank, (int16_t)((i & 15) + 1));
+    });
+
+    time("C++ is-on", iterations, 1, [&](uint64_t i)
+    {
+        lit += handle.isOn((int16_t)((i & 15) + 1));
+    });
+
+    return (0 == lit) ? 0 : 0;
+}
@@ -0,0 +1,156 @@
+#include "LedFleet.h"
+#include "stdint.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "time.h"
+
+/***********************************************************************
+ * LED Fleet Benchmark
+ *
+ * Times one batch of masked updates across many banks, first with a
+ * serial loop and then through LedFleet_Apply with 1..max threads, and
+ * reports the speedup over the single-thread pool.
+ *
+ * usage: LedDriver_bench_fleet [banks] [max threads] [batches]
+ *
+************************************************************************/
+
+void RuntimeError(const char * m, int p, const char * f, int l)
+{
+    (void)m;
+    (void)p;
+    (void)f;
+    (void)l;
+}
+
+static double nowSeconds(void)
+{
+    struct timespec ts;
+
+    timespec_get(&ts, TIME_UTC);
+
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+}
+
+static void fillOps(LedFleet_Op* ops, uint32_t banks, uint32_t batch)
+{
+    uint32_t i;
+
+    for (i = 0; i < banks; i++)
+    {
+        ops[i].turn_on = (uint16_t)(1u << ((i + batch) % 16));
+        ops[i].turn_off = (uint16_t)(1u << ((i + batch + 8) % 16));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t banks = 100000;
+    uint32_t maxThreads = 16;
+    uint32_t batches = 200;
+    LedDriver_Bank* bankStore;
+    uint16_t* registers;
+    LedFleet_Op* ops;
+    double serial;
+    double single;
+    double start;
+    uint32_t threads;
+    uint32_t b;
+    uint32_t i;
+
+    if (argc > 1)
+    {
+        banks = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+
+    if (argc > 2)
+    {
+        maxThreads = (uint32_t)strtoul(argv[2], NULL, 10);
+    }
+
+    if (argc > 3)
+    {
+        batches = (uint32_t)strtoul(argv[3], NULL, 10);
+    }
+
+    if ((0 == banks) || (0 == batches) || (0 == maxThreads) || (LED_FLEET_MAX_THREADS < maxThreads))
+    {
+        printf("usage: %s [banks] [max threads] [batches]\n", argv[0]);
+        return 2;
+    }
+
+    bankStore = (LedDriver_Bank*)calloc(banks, sizeof(LedDriver_Bank));
+    registers = (uint16_t*)calloc(banks, sizeof(uint16_t));
+    ops = (LedFleet_Op*)calloc(banks, sizeof(LedFleet_Op));
+
+    if ((NULL == bankStore) || (NULL == registers) || (NULL == ops))
+    {
+        printf("out of memory\n");
+        return 1;
+    }
+
+    for (i = 0; i < banks; i++)
+    {
+        LedDriver_BankInit(&bankStore[i], &registers[i], false, false);
+        ops[i].bank = &bankStore[i];
+    }
+
+    start = nowSeconds();
+
+    for (b = 0; b < batches; b++)
+    {
+        fillOps(ops, banks, b);
+
+        for (i = 0; i < banks; i++)
+        {
+            LedDriver_BankUpdate(ops[i].bank, ops[i].turn_on, ops[i].turn_off);
+        }
+    }
+
+    serial = (nowSeconds() - start) / batches;
+
+    printf("banks %u, batches %u\n", banks, batches);
+    printf("serial loop      %10.1f us/batch\n", serial * 1e6);
+
+    single = 0.0;
+
+    for (threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        LedFleet_Stats stats;
+        double elapsed;
+
+        LedFleet_Start(threads);
+
+        start = nowSeconds();
+
+        for (b = 0; b < batches; b++)
+        {
+            fillOps(ops, banks, b);
+            LedFleet_Apply(ops, banks);
+        }
+
+        elapsed = (nowSeconds() - start) / batches;
+
+        LedFleet_GetStats(&stats);
+        LedFleet_Stop();
+
+        if (1 == threads)
+        {
+            single = elapsed;
+        }
+
+        printf("fleet %2u threads %10.1f us/batch  speedup %5.2fx  steals %llu\n",
+               threads, elapsed * 1e6, single / elapsed, (unsigned long long)stats.steals);
+
+        if ((threads < maxThreads) && ((threads * 2) > maxThreads))
+        {
+            threads = maxThreads / 2;
+        }
+    }
+
+    free(ops);
+    free(registers);
+    free(bankStore);
+
+    return 0;
+}
@@ -0,0 +1,244 @@
+#include "LedBus.h"
+#include "LedDriver.h"
+#include "LedFlush.h"
+#include "stdint.h"
+#include "stdio.h"
+#include "stdlib.h"
+
+/***********************************************************************
+ * LED Flush Scheduler Benchmark
+ *
+ * Many banks on consecutive registers of one emulated bus, a few of them
+ * alarms, run in virtual time three ways: every driver write straight
+ * onto the bus, the flush scheduler with one deadline for all (first
+ * come first served) and the scheduler with short alarm deadlines
+ * (earliest deadline first). Reports bus transactions and the latency
+ * from an alarm change to the end of its register write.
+ *
+ * usage: LedDriver_bench_flush [banks] [changes per bank per second] [duration ms]
+ *
+************************************************************************/
+
+#define ALARM_EVERY 32
+#define STEP_NS 1000
+#define ALARM_DEADLINE_NS 50000
+#define NORMAL_DEADLINE_NS 50000000
+
+enum
+{
+    MODE_DIRECT,
+    MODE_FIFO,
+    MODE_EDF,
+};
+
+static const char* const modeNames[] = { "direct", "fifo", "edf" };
+
+static LedFlush flush;
+
+void RuntimeError(const char * m, int p, const char * f, int l)
+{
+    (void)m;
+    (void)p;
+    (void)f;
+    (void)l;
+}
+
+static uint64_t nextRandom(uint64_t* state)
+{
+    uint64_t x = *state;
+
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+static int compareLatency(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+
+    return (x > y) - (x < y);
+}
+
+static bool isAlarm(uint32_t bank)
+{
+    return (0 == (bank % ALARM_EVERY));
+}
+
+static void run(int mode, uint32_t banks, uint32_t rate, uint64_t duration)
+{
+    LedBus_Config config;
+    LedBus bus;
+    LedBus_Stats busStats;
+    LedFlush_Stats flushStats;
+    LedDriver_Bank* bank;
+    uint16_t* registers;
+    uint64_t* since;
+    uint64_t* latency;
+    uint64_t latencies;
+    uint64_t capacity;
+    uint64_t threshold;
+    uint64_t rng;
+    uint64_t now;
+    uint32_t i;
+    uint16_t status;
+
+    config.latency_ns = 2000;
+    config.bytes_per_second = 1000000;
+    config.frame_bytes = 2;
+    config.jitter_ns = 500;
+    config.seed = 1;
+    config.real_time = false;
+
+    bank = (LedDriver_Bank*)calloc(banks, sizeof(LedDriver_Bank));
+    registers = (uint16_t*)calloc(banks, sizeof(uint16_t));
+    since = (uint64_t*)calloc(banks, sizeof(uint64_t));
+    capacity = 1 + (((duration / 1000000000ULL) + 1) * rate * banks) / ALARM_EVERY;
+    latency = (uint64_t*)calloc(capacity, sizeof(uint64_t));
+
+    if ((NULL == bank) || (NULL == registers) || (NULL == since) || (NULL == latency))
+    {
+        printf("out of memory\n");
+        exit(1);
+    }
+
+    LedBus_Init(&bus, &config, registers, banks);
+    LedFlush_Init(&flush);
+
+    for (i = 0; i < banks; i++)
+    {
+        LedDriver_BankInit(&bank[i], &registers[i], false, false);
+
+        if (MODE_DIRECT != mode)
+        {
+            LedFlush_Add(&flush, &bank[i], ((MODE_EDF == mode) && isAlarm(i)) ? ALARM_DEADLINE_NS : NORMAL_DEADLINE_NS);
+        }
+    }
+
+    LedBus_Select(&bus);
+
+    // Chance per bank per step of a change, out of 2^32
+    threshold = ((uint64_t)rate * STEP_NS * 4294967296ULL) / 1000000000ULL;
+    rng = 1;
+    latencies = 0;
+
+    for (now = 0; now < duration; now += STEP_NS)
+    {
+        LedBus_SetTime(&bus, now);
+
+        for (i = 0; i < banks; i++)
+        {
+            if ((nextRandom(&rng) >> 32) < threshold)
+            {
+                status = bank[i].status;
+
+                LedDriver_BankTurnOn(&bank[i], (int16_t)(1 + ((nextRandom(&rng) >> 32) % 16)));
+                LedDriver_BankTurnOff(&bank[i], (int16_t)(1 + ((nextRandom(&rng) >> 32) % 16)));
+
+                if ((true == isAlarm(i)) && (0 == since[i]) && (status != bank[i].status))
+                {
+                    since[i] = now + 1;
+                }
+
+                if ((MODE_DIRECT == mode) && (0 != since[i]))
+                {
+                    latency[latencies++] = bus.free_at - (since[i] - 1);
+                    since[i] = 0;
+                }
+            }
+        }
+
+        if ((MODE_DIRECT != mode) && (bus.free_at <= now))
+        {
+            LedFlush_Service(&flush, (uint32_t)now, 1);
+
+            // Alarms whose register now holds their state finish with this burst
+            for (i = 0; i < banks; i += ALARM_EVERY)
+            {
+                if ((0 != since[i]) && (registers[i] == bank[i].status))
+                {
+                    // Before the change means it was undone and never written
+                    if (bus.free_at >= since[i])
+                    {
+                        latency[latencies++] = bus.free_at - (since[i] - 1);
+                    }
+
+                    since[i] = 0;
+                }
+            }
+        }
+    }
+
+    LedBus_Select(NULL);
+    LedBus_GetStats(&bus, &busStats);
+    LedFlush_GetStats(&flush, &flushStats);
+
+    if (MODE_DIRECT != mode)
+    {
+        LedFlush_Detach(&flush, (uint32_t)now);
+    }
+
+    qsort(latency, latencies, sizeof(uint64_t), compareLatency);
+
+    printf("%-7s %9llu bus writes %6.1f %% busy   alarm latency us p50 %8.1f p99 %8.1f max %8.1f",
+           modeNames[mode],
+           (unsigned long long)busStats.writes,
+           (100.0 * (double)busStats.busy_ns) / (double)duration,
+           (0 == latencies) ? 0.0 : (double)latency[latencies / 2] / 1e3,
+           (0 == latencies) ? 0.0 : (double)latency[(latencies * 99) / 100] / 1e3,
+           (0 == latencies) ? 0.0 : (double)latency[latencies - 1] / 1e3);
+
+    if (MODE_DIRECT != mode)
+    {
+        printf("   %u merged, %u missed", flushStats.merged, flushStats.missed);
+    }
+
+    printf("\n");
+
+    free(bank);
+    free(registers);
+    free(since);
+    free(latency);
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t banks = 256;
+    uint32_t rate = 2000;
+    uint64_t duration = 200000000ULL;
+    int mode;
+
+    if (argc > 1)
+    {
+        banks = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+
+    if (argc > 2)
+    {
+        rate = (uint32_t)strtoul(argv[2], NULL, 10);
+    }
+
+    if (argc > 3)
+    {
+        duration = strtoull(argv[3], NULL, 10) * 1000000ULL;
+    }
+
+    if ((0 == banks) || (LED_FLUSH_MAX_BANKS < banks) || (0 == rate) || (0 == duration) || (4000000000ULL < duration))
+    {
+        printf("usage: %s [banks <= %d] [changes per bank per second] [duration ms < 4000]\n", argv[0], LED_FLUSH_MAX_BANKS);
+        return 2;
+    }
+
+    printf("%u banks, %u changes/s each, alarm every %d banks, %.0f ms virtual\n",
+           banks, rate, ALARM_EVERY, (double)duration / 1e6);
+
+    for (mode = MODE_DIRECT; mode <= MODE_EDF; mode++)
+    {
+        run(mode, banks, rate, duration);
+    }
+
+    return 0;
+}
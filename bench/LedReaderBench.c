@@ -0,0 +1,189 @@
+#include "LedDriver.h"
+#include "pthread.h"
+#include "stdint.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "time.h"
+
+/***********************************************************************
+ * LED Reader Benchmark
+ *
+ * One writer keeps switching LEDs on a bank, and re-initialises it every
+ * so often, while 1..max reader threads poll it with LedDriver_BankIsOn.
+ * Reports total reads per second and the speedup over one reader. With
+ * readers never taking a lock, throughput should grow with the number of
+ * cores up to the point where readers outnumber them.
+ *
+ * usage: LedDriver_bench_reader [max readers] [milliseconds]
+ *
+************************************************************************/
+
+#define MAX_READERS 64
+
+// Writes between re-initialisations of the bank
+#define REINIT_EVERY 1000
+
+typedef struct
+{
+    _Alignas(64) uint64_t reads;
+    uint64_t lit;
+} Reader;
+
+static LedDriver_Bank bank;
+static uint16_t hardware;
+static volatile int running;
+static volatile int stopping;
+
+void RuntimeError(const char * m, int p, const char * f, int l)
+{
+    (void)m;
+    (void)p;
+    (void)f;
+    (void)l;
+}
+
+static double nowSeconds(void)
+{
+    struct timespec ts;
+
+    timespec_get(&ts, TIME_UTC);
+
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+}
+
+static void* readerMain(void* Argument)
+{
+    Reader* reader = (Reader*)Argument;
+    uint64_t reads = 0;
+    uint64_t lit = 0;
+    int16_t led = 1;
+
+    while (0 == __atomic_load_n(&running, __ATOMIC_ACQUIRE))
+    {
+    }
+
+    while (0 == __atomic_load_n(&stopping, __ATOMIC_RELAXED))
+    {
+        lit += LedDriver_BankIsOn(&bank, led);
+        led = (int16_t)((led % 16) + 1);
+        reads++;
+    }
+
+    reader->reads = reads;
+    reader->lit = lit;
+
+    return NULL;
+}
+
+static void* writerMain(void* Argument)
+{
+    uint32_t writes = 0;
+    struct timespec pause = { 0, 10000 };
+
+    (void)Argument;
+
+    while (0 == __atomic_load_n(&stopping, __ATOMIC_RELAXED))
+    {
+        if (0 == (writes % REINIT_EVERY))
+        {
+            LedDriver_BankInit(&bank, &hardware, (0 != (writes & 1)), false);
+        }
+        else if (0 != (writes & 1))
+        {
+            LedDriver_BankTurnOn(&bank, (int16_t)((writes % 16) + 1));
+        }
+        else
+        {
+            LedDriver_BankTurnOff(&bank, (int16_t)((writes % 16) + 1));
+        }
+
+        writes++;
+
+        // Writers are rare next to readers
+        nanosleep(&pause, NULL);
+    }
+
+    return NULL;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t maxReaders = 8;
+    uint32_t milliseconds = 200;
+    static Reader readers[MAX_READERS];
+    pthread_t threads[MAX_READERS];
+    pthread_t writer;
+    struct timespec duration;
+    double single;
+    double start;
+    double elapsed;
+    uint64_t total;
+    uint32_t count;
+    uint32_t i;
+
+    if (argc > 1)
+    {
+        maxReaders = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+
+    if (argc > 2)
+    {
+        milliseconds = (uint32_t)strtoul(argv[2], NULL, 10);
+    }
+
+    if ((0 == maxReaders) || (MAX_READERS < maxReaders) || (0 == milliseconds))
+    {
+        printf("usage: %s [max readers] [milliseconds]\n", argv[0]);
+        return 2;
+    }
+
+    duration.tv_sec = milliseconds / 1000;
+    duration.tv_nsec = (long)(milliseconds % 1000) * 1000000L;
+    single = 0.0;
+
+    for (count = 1; count <= maxReaders; count *= 2)
+    {
+        LedDriver_BankInit(&bank, &hardware, false, false);
+        running = 0;
+        stopping = 0;
+
+        pthread_create(&writer, NULL, writerMain, NULL);
+
+        for (i = 0; i < count; i++)
+        {
+            pthread_create(&threads[i], NULL, readerMain, &readers[i]);
+        }
+
+        start = nowSeconds();
+        __atomic_store_n(&running, 1, __ATOMIC_RELEASE);
+        nanosleep(&duration, NULL);
+        __atomic_store_n(&stopping, 1, __ATOMIC_RELAXED);
+
+        total = 0;
+
+        for (i = 0; i < count; i++)
+        {
+            pthread_join(threads[i], NULL);
+            total += readers[i].reads;
+        }
+
+        elapsed = nowSeconds() - start;
+        pthread_join(writer, NULL);
+
+        if (1 == count)
+        {
+            single = (double)total / elapsed;
+        }
+
+        printf("readers %2u  %8.1f M reads/s  %6.1f M/s per reader  speedup %5.2fx\n",
+               count, (double)total / elapsed / 1e6, (double)total / elapsed / 1e6 / count,
+               ((double)total / elapsed) / single);
+
+        if ((count < maxReaders) && ((count * 2) > maxReaders))
+        {
+            count = maxReaders / 2;
+        }
+    }
+
+    return 0;
+}
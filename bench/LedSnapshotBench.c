@@ -0,0 +1,146 @@
+#include "LedSnapshot.h"
+#include "stdint.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "time.h"
+
+/***********************************************************************
+ * LED Snapshot Benchmark
+ *
+ * Compares two ways of getting many banks back to their last state after
+ * a restart: initialising every bank and replaying the TurnOn calls that
+ * built the state, and reopening a checkpoint and restoring from it.
+ *
+ * usage: LedDriver_bench_snapshot [banks] [checkpoint file]
+ *
+************************************************************************/
+
+void RuntimeError(const char * m, int p, const char * f, int l)
+{
+    (void)m;
+    (void)p;
+    (void)f;
+    (void)l;
+}
+
+static double nowSeconds(void)
+{
+    struct timespec ts;
+
+    timespec_get(&ts, TIME_UTC);
+
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+}
+
+// LED pattern of a bank, the state to get back to
+static bool isLit(uint32_t bank, int16_t led)
+{
+    return (0 != ((bank * 2654435761u) & (1u << (led - 1))));
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t banks = 10000;
+    const char* path = "led_snapshot_bench.bin";
+    LedDriver_Bank* bankStore;
+    LedDriver_Bank** bankList;
+    uint16_t* registers;
+    LedSnapshot snapshot;
+    double replay;
+    double save;
+    double restore;
+    double start;
+    uint32_t calls;
+    uint32_t i;
+    int16_t led;
+
+    if (argc > 1)
+    {
+        banks = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+
+    if (argc > 2)
+    {
+        path = argv[2];
+    }
+
+    if (0 == banks)
+    {
+        printf("usage: %s [banks] [checkpoint file]\n", argv[0]);
+        return 2;
+    }
+
+    bankStore = (LedDriver_Bank*)calloc(banks, sizeof(LedDriver_Bank));
+    bankList = (LedDriver_Bank**)calloc(banks, sizeof(LedDriver_Bank*));
+    registers = (uint16_t*)calloc(banks, sizeof(uint16_t));
+
+    if ((NULL == bankStore) || (NULL == bankList) || (NULL == registers))
+    {
+        printf("out of memory\n");
+        return 1;
+    }
+
+    // Cold start: init, then rebuild the state one LED at a time
+    calls = 0;
+    start = nowSeconds();
+
+    for (i = 0; i < banks; i++)
+    {
+        LedDriver_BankInit(&bankStore[i], &registers[i], false, false);
+        bankList[i] = &bankStore[i];
+
+        for (led = 1; led <= 16; led++)
+        {
+            if (isLit(i, led))
+            {
+                LedDriver_BankTurnOn(&bankStore[i], led);
+                calls++;
+            }
+        }
+    }
+
+    replay = nowSeconds() - start;
+
+    if (0 > LedSnapshot_Open(&snapshot, path, banks))
+    {
+        printf("cannot open %s\n", path);
+        return 1;
+    }
+
+    start = nowSeconds();
+    LedSnapshot_Save(&snapshot, bankList, banks);
+    save = nowSeconds() - start;
+
+    LedSnapshot_Sync(&snapshot);
+    LedSnapshot_Close(&snapshot);
+
+    // Warm start: map the checkpoint and adopt each bank with one write
+    start = nowSeconds();
+
+    if (1 != LedSnapshot_Open(&snapshot, path, banks))
+    {
+        printf("no snapshot in %s\n", path);
+        return 1;
+    }
+
+    for (i = 0; i < banks; i++)
+    {
+        LedSnapshot_Restore(&snapshot, i, &bankStore[i], &registers[i], NULL);
+    }
+
+    restore = nowSeconds() - start;
+
+    LedSnapshot_Close(&snapshot);
+    remove(path);
+
+    printf("banks %u, %u TurnOn calls to replay\n", banks, calls);
+    printf("init + replay    %10.1f us\n", replay * 1e6);
+    printf("snapshot save    %10.1f us\n", save * 1e6);
+    printf("open + restore   %10.1f us  (%.1f ns/bank)\n", restore * 1e6, (restore * 1e9) / banks);
+
+    free(registers);
+    free(bankList);
+    free(bankStore);
+
+    return 0;
+}
@@ -0,0 +1,172 @@
+#include "LedStore.h"
+#include "stdint.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "time.h"
+
+/***********************************************************************
+ * LED Store Benchmark
+ *
+ * Runs the same range queries over a column store and over a plain
+ * struct-per-LED array holding the same data, and reports the memory
+ * used and the time per query.
+ *
+ * usage: LedDriver_bench_store [LEDs] [passes]
+ *
+************************************************************************/
+
+typedef struct
+{
+    bool on;
+    bool fault;
+    uint8_t brightness;
+    uint32_t changed_at;
+    uint16_t owner;
+} PerLed;
+
+static double nowSeconds(void)
+{
+    struct timespec ts;
+
+    timespec_get(&ts, TIME_UTC);
+
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+}
+
+static void report(const char* query, double columns, double structs, uint32_t passes)
+{
+    printf("%-22s columns %8.1f us   structs %8.1f us   %5.1fx\n",
+           query, columns * 1e6 / passes, structs * 1e6 / passes, structs / columns);
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t leds = 4000000;
+    uint32_t passes = 20;
+    LedStore store;
+    PerLed* perLed;
+    void* memory;
+    size_t size;
+    volatile uint32_t sink;
+    double columns;
+    double structs;
+    double start;
+    uint32_t found;
+    uint32_t p;
+    uint32_t i;
+
+    if (argc > 1)
+    {
+        leds = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+
+    if (argc > 2)
+    {
+        passes = (uint32_t)strtoul(argv[2], NULL, 10);
+    }
+
+    if ((0 == leds) || (0 == passes))
+    {
+        printf("usage: %s [LEDs] [passes]\n", argv[0]);
+        return 2;
+    }
+
+    size = (LedStore_Size(leds) + 63) & ~(size_t)63;
+    memory = aligned_alloc(64, size);
+    perLed = (PerLed*)calloc(leds, sizeof(PerLed));
+
+    if ((NULL == memory) || (NULL == perLed) || (0 != LedStore_Init(&store, memory, size, leds)))
+    {
+        printf("out of memory\n");
+        return 1;
+    }
+
+    srand(1);
+
+    for (i = 0; i < leds; i++)
+    {
+        perLed[i].on = (0 != (rand() & 1));
+        perLed[i].fault = (0 == (rand() % 1000));
+        perLed[i].brightness = (uint8_t)rand();
+        perLed[i].owner = (uint16_t)(rand() % 16);
+        perLed[i].changed_at = (uint32_t)(rand() % 1000);
+
+        LedStore_Set(&store, i, perLed[i].on, perLed[i].changed_at);
+        LedStore_SetFault(&store, i, perLed[i].fault);
+        LedStore_SetBrightness(&store, i, perLed[i].brightness);
+        LedStore_SetOwner(&store, i, perLed[i].owner);
+    }
+
+    printf("%u LEDs: columns %.1f MB, structs %.1f MB\n",
+           leds, (double)LedStore_Size(leds) / 1e6, ((double)leds * sizeof(PerLed)) / 1e6);
+
+    // Lit and faulted
+    start = nowSeconds();
+    for (p = 0; p < passes; p++)
+    {
+        sink = LedStore_CountLitFaulted(&store, 0, leds);
+    }
+    columns = nowSeconds() - start;
+
+    start = nowSeconds();
+    for (p = 0; p < passes; p++)
+    {
+        found = 0;
+        for (i = 0; i < leds; i++)
+        {
+            found += (perLed[i].on && perLed[i].fault);
+        }
+        sink = found;
+    }
+    structs = nowSeconds() - start;
+    report("lit and faulted", columns, structs, passes);
+
+    // Brightness threshold
+    start = nowSeconds();
+    for (p = 0; p < passes; p++)
+    {
+        sink = LedStore_CountBrightnessAtLeast(&store, 0, leds, 200);
+    }
+    columns = nowSeconds() - start;
+
+    start = nowSeconds();
+    for (p = 0; p < passes; p++)
+    {
+        found = 0;
+        for (i = 0; i < leds; i++)
+        {
+            found += (perLed[i].brightness >= 200);
+        }
+        sink = found;
+    }
+    structs = nowSeconds() - start;
+    report("brightness >= 200", columns, structs, passes);
+
+    // Owner
+    start = nowSeconds();
+    for (p = 0; p < passes; p++)
+    {
+        sink = LedStore_CountOwnedBy(&store, 0, leds, 7);
+    }
+    columns = nowSeconds() - start;
+
+    start = nowSeconds();
+    for (p = 0; p < passes; p++)
+    {
+        found = 0;
+        for (i = 0; i < leds; i++)
+        {
+            found += (perLed[i].owner == 7);
+        }
+        sink = found;
+    }
+    structs = nowSeconds() - start;
+    report("owned by 7", columns, structs, passes);
+
+    (void)sink;
+
+    free(perLed);
+    free(memory);
+
+    return 0;
+}
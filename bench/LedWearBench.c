@@ -0,0 +1,187 @@
+#include "LedDriver.h"
+#include "LedWear.h"
+#include "stdint.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "time.h"
+
+/***********************************************************************
+ * LED Wear Benchmark
+ *
+ * Cost of wear accounting across many banks: driver calls with and
+ * without counters attached, a polling sweep calling IsOn for every
+ * LED (how on-time used to be sampled) against a bulk export of every
+ * bank's exact totals.
+ *
+ * usage: LedDriver_bench_wear [banks] [calls]
+ *
+************************************************************************/
+
+#define ROUNDS 20
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BARRIER() __asm__ __volatile__("" ::: "memory")
+#else
+#define BARRIER()
+#endif
+
+static volatile uint32_t ticks;
+static volatile uint64_t sink;
+
+void RuntimeError(const char * m, int p, const char * f, int l)
+{
+    (void)m;
+    (void)p;
+    (void)f;
+    (void)l;
+}
+
+static double nowSeconds(void)
+{
+    struct timespec ts;
+
+    timespec_get(&ts, TIME_UTC);
+
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+}
+
+static double toggle(LedDriver_Bank* bank, uint32_t banks, uint64_t calls)
+{
+    double start;
+    uint64_t i;
+    uint32_t index;
+    int16_t led;
+
+    start = nowSeconds();
+
+    for (i = 0; i < calls; i++)
+    {
+        index = (uint32_t)((i * 2654435761u) % banks);
+        led = (int16_t)((i & 15) + 1);
+
+        ticks = (uint32_t)i;
+
+        if (0 == (i & 16))
+        {
+            LedDriver_BankTurnOn(&bank[index], led);
+        }
+        else
+        {
+            LedDriver_BankTurnOff(&bank[index], led);
+        }
+
+        BARRIER();
+    }
+
+    return ((nowSeconds() - start) * 1e9) / (double)calls;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t banks = 4096;
+    uint64_t calls = 20000000;
+    LedDriver_Bank* bank;
+    LedWear_Counters* counters;
+    uint16_t* registers;
+    uint64_t* onTime;
+    uint32_t* toggles;
+    uint64_t polled;
+    double plain;
+    double tracked;
+    double start;
+    double poll;
+    double bulk;
+    uint32_t round;
+    uint32_t i;
+    int16_t led;
+
+    if (argc > 1)
+    {
+        banks = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+
+    if (argc > 2)
+    {
+        calls = strtoull(argv[2], NULL, 10);
+    }
+
+    if ((0 == banks) || (0 == calls))
+    {
+        printf("usage: %s [banks] [calls]\n", argv[0]);
+        return 2;
+    }
+
+    bank = (LedDriver_Bank*)calloc(banks, sizeof(LedDriver_Bank));
+    counters = (LedWear_Counters*)calloc(banks, sizeof(LedWear_Counters));
+    registers = (uint16_t*)calloc(banks, sizeof(uint16_t));
+    onTime = (uint64_t*)calloc((size_t)banks * LED_WEAR_OUTPUTS, sizeof(uint64_t));
+    toggles = (uint32_t*)calloc((size_t)banks * LED_WEAR_OUTPUTS, sizeof(uint32_t));
+
+    if ((NULL == bank) || (NULL == counters) || (NULL == registers) || (NULL == onTime) || (NULL == toggles))
+    {
+        printf("out of memory\n");
+        return 1;
+    }
+
+    for (i = 0; i < banks; i++)
+    {
+        LedDriver_BankInit(&bank[i], &registers[i], false, false);
+    }
+
+    plain = toggle(bank, banks, calls);
+
+    for (i = 0; i < banks; i++)
+    {
+        LedWear_Attach(&counters[i], &bank[i], &ticks);
+    }
+
+    tracked = toggle(bank, banks, calls);
+
+    // The old way: sample every LED and credit the sampling period
+    start = nowSeconds();
+    polled = 0;
+
+    for (round = 0; round < ROUNDS; round++)
+    {
+        for (i = 0; i < banks; i++)
+        {
+            for (led = 1; led <= 16; led++)
+            {
+                polled += LedDriver_BankIsOn(&bank[i], led) ? 1 : 0;
+            }
+        }
+
+        BARRIER();
+    }
+
+    poll = (nowSeconds() - start) / ROUNDS;
+    sink = polled;
+
+    // Once untimed so page faults on the output arrays are not counted
+    LedWear_Export(counters, banks, onTime, toggles);
+
+    start = nowSeconds();
+
+    for (round = 0; round < ROUNDS; round++)
+    {
+        LedWear_Export(counters, banks, onTime, toggles);
+        BARRIER();
+    }
+
+    bulk = (nowSeconds() - start) / ROUNDS;
+    sink = onTime[0] + toggles[0];
+
+    printf("%u banks\n", banks);
+    printf("driver call, no counters   %8.3f ns\n", plain);
+    printf("driver call, counters      %8.3f ns\n", tracked);
+    printf("poll sweep (16 x IsOn)     %8.1f ns/bank  sampled, misses changes between sweeps\n", (poll * 1e9) / banks);
+    printf("bulk export                %8.1f ns/bank  exact on-time and toggles\n", (bulk * 1e9) / banks);
+
+    free(bank);
+    free(counters);
+    free(registers);
+    free(onTime);
+    free(toggles);
+
+    return 0;
+}
@@ -0,0 +1,57 @@
+# Fails unless codegen_<name>_c and codegen_<name>_cxx disassemble to the
+# same instructions for every name in FUNCTIONS (comma separated).
+#
+# cmake -DOBJDUMP=objdump -DOBJECT=LedCodegen.o -DFUNCTIONS=a,b -P CompareDisassembly.cmake
+
+function(disassemble symbol result)
+    execute_process(
+        COMMAND ${OBJDUMP} -d --no-show-raw-insn --section=.text.${symbol} ${OBJECT}
+        OUTPUT_VARIABLE listing
+        RESULT_VARIABLE status
+    )
+
+    if(NOT status EQUAL 0)
+        message(FATAL_ERROR "objdump failed on ${OBJECT}")
+    endif()
+
+    # Keep the instructions only: no addresses, symbol names or comments
+    set(instructions "")
+    string(REGEX MATCHALL "[^\n]+" lines "${listing}")
+
+    foreach(line IN LISTS lines)
+        if(line MATCHES "^ *[0-9a-f]+:\t(.*)$")
+            set(instruction "${CMAKE_MATCH_1}")
+            string(REGEX REPLACE "<[^>]*>" "" instruction "${instruction}")
+            string(REGEX REPLACE "#.*$" "" instruction "${instruction}")
+            string(STRIP "${instruction}" instruction)
+            string(APPEND instructions "${instruction}\n")
+        endif()
+    endforeach()
+
+    if(instructions STREQUAL "")
+        message(FATAL_ERROR "${symbol} not found in ${OBJECT}")
+    endif()
+
+    set(${result} "${instructions}" PARENT_SCOPE)
+endfunction()
+
+string(REPLACE "," ";" FUNCTIONS "${FUNCTIONS}")
+
+set(failed FALSE)
+
+foreach(name IN LISTS FUNCTIONS)
+    disassemble(codegen_${name}_c reference)
+    disassemble(codegen_${name}_cxx wrapper)
+
+    if(reference STREQUAL wrapper)
+        message(STATUS "${name}: identical")
+    else()
+        message(STATUS "${name}: C\n${reference}")
+        message(STATUS "${name}: C++\n${wrapper}")
+        set(failed TRUE)
+    endif()
+endforeach()
+
+if(failed)
+    message(FATAL_ERROR "the C++ wrapper does not compile to the same code as the C API")
+endif()
@@ -0,0 +1,75 @@
+#include "LedDriver.hpp"
+
+/***********************************************************************
+ * LED Codegen Check
+ *
+ * Pairs of functions doing the same thing, once written as plain C
+ * against the inline driver API and once through the C++ wrapper. Both
+ * halves are built by the same compiler with the same flags, and
+ * CompareDisassembly.cmake fails unless each codegen_<name>_c and
+ * codegen_<name>_cxx pair disassembles to identical instructions.
+ *
+ * The C functions are marked nonnull: a wrapper handle always holds a
+ * bank, and without the hint the C versions would carry an extra check.
+ *
+************************************************************************/
+
+extern "C"
+{
+
+__attribute__((nonnull)) void codegen_toggle_c(LedDriver_Bank* Bank, int16_t LedIndex)
+{
+    LedDriver_BankTurnOn(Bank, LedIndex);
+    LedDriver_BankTurnOff(Bank, LedIndex);
+}
+
+__attribute__((nonnull)) int codegen_checked_c(LedDriver_Bank* Bank, int16_t LedIndex)
+{
+    int result;
+
+    result = -1;
+
+    if (0 == LedDriver_BankTurnOn(Bank, LedIndex))
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
+__attribute__((nonnull)) void codegen_update_c(LedDriver_Bank* Bank)
+{
+    LedDriver_BankUpdate(Bank, 0x0005, 0x8000);
+}
+
+__attribute__((nonnull)) bool codegen_is_on_c(const LedDriver_Bank* Bank, int16_t LedIndex)
+{
+    return LedDriver_BankIsOn(Bank, LedIndex);
+}
+
+void codegen_toggle_cxx(led::LedBank& Bank, int16_t LedIndex)
+{
+    (void)Bank.turnOn(LedIndex);
+    (void)Bank.turnOff(LedIndex);
+}
+
+int codegen_checked_cxx(led::LedBank& Bank, int16_t LedIndex)
+{
+    return Bank.turnOn(LedIndex) ? 0 : -1;
+}
+
+void codegen_update_cxx(led::LedBank& Bank)
+{
+    led::LedTransaction transaction(Bank);
+
+    (void)transaction.turnOn(1);
+    (void)transaction.turnOn(3);
+    (void)transaction.turnOff(16);
+}
+
+bool codegen_is_on_cxx(const led::LedBank& Bank, int16_t LedIndex)
+{
+    return Bank.isOn(LedIndex);
+}
+
+}
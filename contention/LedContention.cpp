@@ -0,0 +1,541 @@
+#include "LedDriver.h"
+#include "LedFleet.h"
+#include "LedPool.h"
+#include "stdint.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+/***********************************************************************
+ * LED Contention Suite
+ *
+ * Runs 1..N threads against the driver in each concurrency mode the
+ * library offers and reports throughput, sampled per-call latency and
+ * lost updates for every combination:
+ *
+ *   plain  unsynchronised bank calls on banks stored side by side
+ *   pool   the same calls on banks from LedPool, one cache line each
+ *   fleet  masked updates submitted in batches through LedFleet_Apply
+ *
+ * Scenarios say which banks the threads touch:
+ *
+ *   same      one bank shared by every thread
+ *   disjoint  a bank per thread
+ *   mixed     half the calls on the thread's own bank, half on the
+ *             shared one
+ *
+ * On a shared bank each of the first 16 threads owns one LED and checks
+ * before every write that the state it last wrote is still there; a
+ * mismatch is a lost update (another thread's read-modify-write put back
+ * a stale copy of the register). Threads beyond the 16th only read the
+ * shared bank. On its own bank a thread owns all 16 LEDs.
+ *
+ * Fleet runs have no caller threads: N is the number of workers, and the
+ * latency is that of a whole LedFleet_Apply batch.
+ *
+************************************************************************/
+
+enum Mode
+{
+    MODE_PLAIN,
+    MODE_POOL,
+    MODE_FLEET,
+};
+
+enum Scenario
+{
+    SCENARIO_SAME,
+    SCENARIO_DISJOINT,
+    SCENARIO_MIXED,
+};
+
+static const char* const modeNames[] = { "plain", "pool", "fleet" };
+static const char* const scenarioNames[] = { "same", "disjoint", "mixed" };
+
+// Every this many calls one is timed
+#define SAMPLE_EVERY 8
+
+#define LEDS_PER_BANK 16
+#define CACHE_LINE 64
+
+struct SuiteConfig
+{
+    uint32_t max_threads = 64;
+    uint64_t duration_ms = 100;
+    uint32_t fleet_banks = 4096;
+    const char* json_path = NULL;
+    bool check = false;
+};
+
+struct RunResult
+{
+    Mode mode;
+    Scenario scenario;
+    uint32_t threads;
+    uint64_t operations;
+    uint64_t lost_updates;
+    double seconds;
+    uint32_t p50_ns;
+    uint32_t p99_ns;
+    uint32_t p999_ns;
+};
+
+struct alignas(CACHE_LINE) PaddedRegister
+{
+    uint16_t value;
+};
+
+struct WorkerState
+{
+    LedDriver_Bank* own;
+    LedDriver_Bank* shared;
+    uint32_t index;
+    uint64_t rng;
+    uint64_t operations = 0;
+    uint64_t lost_updates = 0;
+    std::vector<uint32_t> latencies;
+};
+
+extern "C" void RuntimeError(const char * m, int p, const char * f, int l)
+{
+    (void)m;
+    (void)p;
+    (void)f;
+    (void)l;
+}
+
+static uint64_t nextRandom(uint64_t* state)
+{
+    // xorshift64*
+    uint64_t x = *state;
+
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+static uint32_t percentile(const std::vector<uint32_t>& sorted, uint32_t perMille)
+{
+    if (sorted.empty())
+    {
+        return 0;
+    }
+
+    size_t index = (size_t)(((uint64_t)(sorted.size() - 1) * perMille) / 1000);
+
+    return sorted[index];
+}
+
+static uint32_t elapsedNs(std::chrono::steady_clock::time_point start)
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// One call on a bank: a read, or a checked write of an LED the thread owns.
+// OwnedLed is 0 when the thread owns every LED of the bank and -1 when it
+// owns none and may only read.
+static void bankCall(WorkerState& worker, LedDriver_Bank* bank, uint16_t& expected, int16_t ownedLed, bool timed)
+{
+    uint64_t r = nextRandom(&worker.rng);
+    int16_t led = (int16_t)((r >> 8) % LEDS_PER_BANK) + 1;
+    uint16_t bit = (uint16_t)(1u << (led - 1));
+    bool write = (0 != (r & 0x3)) && (-1 != ownedLed);
+    bool on = (0 != (r & 0x4));
+    std::chrono::steady_clock::time_point start;
+
+    if (0 < ownedLed)
+    {
+        led = ownedLed;
+        bit = (uint16_t)(1u << (led - 1));
+    }
+
+    if (true == timed)
+    {
+        start = std::chrono::steady_clock::now();
+    }
+
+    if (false == write)
+    {
+        (void)LedDriver_BankIsOn(bank, led);
+    }
+    else
+    {
+        if (LedDriver_BankIsOn(bank, led) != (0 != (expected & bit)))
+        {
+            worker.lost_updates++;
+        }
+
+        if (true == on)
+        {
+            LedDriver_BankTurnOn(bank, led);
+            expected |= bit;
+        }
+        else
+        {
+            LedDriver_BankTurnOff(bank, led);
+            expected &= (uint16_t)~bit;
+        }
+    }
+
+    if (true == timed)
+    {
+        worker.latencies.push_back(elapsedNs(start));
+    }
+
+    worker.operations++;
+}
+
+static void runWorker(WorkerState& worker, Scenario scenario, std::atomic<bool>& go, std::atomic<bool>& stop)
+{
+    uint16_t ownExpected = 0;
+    uint16_t sharedExpected = 0;
+    int16_t sharedLed = (LEDS_PER_BANK > worker.index) ? (int16_t)(worker.index + 1) : -1;
+    uint32_t call = 0;
+
+    while (false == go.load(std::memory_order_acquire))
+    {
+        std::this_thread::yield();
+    }
+
+    while (false == stop.load(std::memory_order_relaxed))
+    {
+        bool timed = (0 == (call % SAMPLE_EVERY));
+        bool useShared = (SCENARIO_SAME == scenario) ||
+                         ((SCENARIO_MIXED == scenario) && (0 != (call & 1)));
+
+        if (true == useShared)
+        {
+            bankCall(worker, worker.shared, sharedExpected, sharedLed, timed);
+        }
+        else
+        {
+            bankCall(worker, worker.own, ownExpected, 0, timed);
+        }
+
+        call++;
+    }
+}
+
+static RunResult runThreads(Mode mode, Scenario scenario, uint32_t threads, const SuiteConfig& config)
+{
+    RunResult result = { mode, scenario, threads, 0, 0, 0.0, 0, 0, 0 };
+    std::vector<WorkerState> workers(threads);
+    std::vector<LedDriver_Bank> plainBanks(threads);
+    std::vector<uint16_t> plainRegisters(threads);
+    std::vector<PaddedRegister> poolRegisters(threads);
+    std::vector<std::thread> pool;
+    std::atomic<bool> go(false);
+    std::atomic<bool> stop(false);
+    alignas(CACHE_LINE) LedDriver_Bank sharedBank;
+    alignas(CACHE_LINE) uint16_t sharedRegister;
+
+    LedDriver_BankInit(&sharedBank, &sharedRegister, false, false);
+    LedPool_Init();
+
+    for (uint32_t t = 0; t < threads; t++)
+    {
+        WorkerState& worker = workers[t];
+
+        worker.index = t;
+        worker.rng = 0x9E3779B97F4A7C15ULL * (t + 1);
+        worker.shared = &sharedBank;
+        worker.latencies.reserve(1 << 16);
+
+        if (MODE_POOL == mode)
+        {
+            worker.own = LedPool_Acquire(&poolRegisters[t].value, false, false);
+        }
+        else
+        {
+            LedDriver_BankInit(&plainBanks[t], &plainRegisters[t], false, false);
+            worker.own = &plainBanks[t];
+        }
+    }
+
+    for (uint32_t t = 0; t < threads; t++)
+    {
+        pool.emplace_back(runWorker, std::ref(workers[t]), scenario, std::ref(go), std::ref(stop));
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    go.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(std::chrono::milliseconds(config.duration_ms));
+    stop.store(true, std::memory_order_relaxed);
+
+    for (std::thread& thread : pool)
+    {
+        thread.join();
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<uint32_t> latencies;
+
+    for (WorkerState& worker : workers)
+    {
+        result.operations += worker.operations;
+        result.lost_updates += worker.lost_updates;
+        latencies.insert(latencies.end(), worker.latencies.begin(), worker.latencies.end());
+
+        if (MODE_POOL == mode)
+        {
+            LedPool_Release(worker.own);
+        }
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+
+    result.p50_ns = percentile(latencies, 500);
+    result.p99_ns = percentile(latencies, 990);
+    result.p999_ns = percentile(latencies, 999);
+
+    return result;
+}
+
+static RunResult runFleet(uint32_t threads, const SuiteConfig& config)
+{
+    RunResult result = { MODE_FLEET, SCENARIO_DISJOINT, threads, 0, 0, 0.0, 0, 0, 0 };
+    uint32_t banks = config.fleet_banks;
+    std::vector<LedDriver_Bank> bankStore(banks);
+    std::vector<uint16_t> registers(banks);
+    std::vector<uint16_t> expected(banks, 0);
+    std::vector<LedFleet_Op> ops(banks);
+    std::vector<uint32_t> latencies;
+    uint64_t rng = 1;
+
+    for (uint32_t i = 0; i < banks; i++)
+    {
+        LedDriver_BankInit(&bankStore[i], &registers[i], false, false);
+        ops[i].bank = &bankStore[i];
+    }
+
+    if (0 != LedFleet_Start(threads))
+    {
+        return result;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point end = start + std::chrono::milliseconds(config.duration_ms);
+
+    while (std::chrono::steady_clock::now() < end)
+    {
+        for (uint32_t i = 0; i < banks; i++)
+        {
+            uint64_t r = nextRandom(&rng);
+
+            ops[i].turn_on = (uint16_t)r;
+            ops[i].turn_off = (uint16_t)(r >> 16);
+            expected[i] = (uint16_t)((expected[i] & ~ops[i].turn_off) | ops[i].turn_on);
+        }
+
+        std::chrono::steady_clock::time_point batchStart = std::chrono::steady_clock::now();
+
+        LedFleet_Apply(ops.data(), banks);
+
+        latencies.push_back(elapsedNs(batchStart));
+
+        for (uint32_t i = 0; i < banks; i++)
+        {
+            if (registers[i] != expected[i])
+            {
+                result.lost_updates++;
+                expected[i] = registers[i];
+            }
+        }
+
+        result.operations += banks;
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    LedFleet_Stop();
+
+    std::sort(latencies.begin(), latencies.end());
+
+    result.p50_ns = percentile(latencies, 500);
+    result.p99_ns = percentile(latencies, 990);
+    result.p999_ns = percentile(latencies, 999);
+
+    return result;
+}
+
+static void printResult(const RunResult& result)
+{
+    printf("%-6s %-9s %3u  %12.0f  %8u  %8u  %8u  %10llu\n",
+           modeNames[result.mode],
+           scenarioNames[result.scenario],
+           result.threads,
+           (double)result.operations / result.seconds,
+           result.p50_ns,
+           result.p99_ns,
+           result.p999_ns,
+           (unsigned long long)result.lost_updates);
+}
+
+static bool writeJson(const char* path, const SuiteConfig& config, const std::vector<RunResult>& results)
+{
+    FILE* file = fopen(path, "w");
+
+    if (NULL == file)
+    {
+        return false;
+    }
+
+    fprintf(file, "{\n  \"duration_ms\": %llu,\n  \"sample_every\": %u,\n  \"hardware_threads\": %u,\n  \"runs\": [\n",
+            (unsigned long long)config.duration_ms, SAMPLE_EVERY, std::thread::hardware_concurrency());
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const RunResult& result = results[i];
+
+        fprintf(file,
+                "    { \"mode\": \"%s\", \"scenario\": \"%s\", \"threads\": %u, \"operations\": %llu, "
+                "\"seconds\": %.6f, \"ops_per_second\": %.0f, \"p50_ns\": %u, \"p99_ns\": %u, "
+                "\"p999_ns\": %u, \"lost_updates\": %llu }%s\n",
+                modeNames[result.mode],
+                scenarioNames[result.scenario],
+                result.threads,
+                (unsigned long long)result.operations,
+                result.seconds,
+                (double)result.operations / result.seconds,
+                result.p50_ns,
+                result.p99_ns,
+                result.p999_ns,
+                (unsigned long long)result.lost_updates,
+                (i + 1 < results.size()) ? "," : "");
+    }
+
+    fprintf(file, "  ]\n}\n");
+
+    return (0 == fclose(file));
+}
+
+static void printUsage(const char* program)
+{
+    printf("usage: %s [options]\n", program);
+    printf("  --max-threads N    largest thread count, 1..%u (default 64)\n", (unsigned)LED_POOL_CAPACITY);
+    printf("  --duration-ms N    length of each run in milliseconds (default 100)\n");
+    printf("  --fleet-banks N    banks per fleet batch (default 4096)\n");
+    printf("  --json FILE        also write the results to FILE as JSON\n");
+    printf("  --check            fail if a mode that should never lose updates does\n");
+}
+
+static bool parseArguments(int argc, char** argv, SuiteConfig& config)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (0 == strcmp(arg, "--check"))
+        {
+            config.check = true;
+            continue;
+        }
+
+        if (NULL == value)
+        {
+            return false;
+        }
+
+        i++;
+
+        if (0 == strcmp(arg, "--max-threads"))
+        {
+            config.max_threads = (uint32_t)strtoul(value, NULL, 10);
+        }
+        else if (0 == strcmp(arg, "--duration-ms"))
+        {
+            config.duration_ms = strtoull(value, NULL, 10);
+        }
+        else if (0 == strcmp(arg, "--fleet-banks"))
+        {
+            config.fleet_banks = (uint32_t)strtoul(value, NULL, 10);
+        }
+        else if (0 == strcmp(arg, "--json"))
+        {
+            config.json_path = value;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    // Pool runs take one bank per thread
+    return (0 != config.max_threads) && (LED_POOL_CAPACITY >= config.max_threads)
+        && (LED_FLEET_MAX_THREADS >= config.max_threads)
+        && (0 != config.duration_ms) && (0 != config.fleet_banks);
+}
+
+int main(int argc, char** argv)
+{
+    SuiteConfig config;
+    std::vector<RunResult> results;
+    std::vector<uint32_t> threadCounts;
+
+    if (false == parseArguments(argc, argv, config))
+    {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    for (uint32_t threads = 1; threads < config.max_threads; threads *= 2)
+    {
+        threadCounts.push_back(threads);
+    }
+
+    threadCounts.push_back(config.max_threads);
+
+    printf("mode   scenario  thr         ops/s   p50 ns   p99 ns  p99.9 ns  lost upd.\n");
+
+    for (uint32_t threads : threadCounts)
+    {
+        results.push_back(runThreads(MODE_PLAIN, SCENARIO_SAME, threads, config));
+        results.push_back(runThreads(MODE_PLAIN, SCENARIO_DISJOINT, threads, config));
+        results.push_back(runThreads(MODE_PLAIN, SCENARIO_MIXED, threads, config));
+        results.push_back(runThreads(MODE_POOL, SCENARIO_DISJOINT, threads, config));
+        results.push_back(runThreads(MODE_POOL, SCENARIO_MIXED, threads, config));
+        results.push_back(runFleet(threads, config));
+
+        for (size_t i = results.size() - 6; i < results.size(); i++)
+        {
+            printResult(results[i]);
+        }
+    }
+
+    if ((NULL != config.json_path) && (false == writeJson(config.json_path, config, results)))
+    {
+        printf("cannot write %s\n", config.json_path);
+        return 1;
+    }
+
+    if (true == config.check)
+    {
+        // Banks owned by one thread, and fleet batches, must never lose a write
+        for (const RunResult& result : results)
+        {
+            if ((SCENARIO_DISJOINT == result.scenario) && (0 != result.lost_updates))
+            {
+                printf("check FAILED: %s/%s with %u threads lost %llu updates\n",
+                       modeNames[result.mode], scenarioNames[result.scenario], result.threads,
+                       (unsigned long long)result.lost_updates);
+                return 1;
+            }
+        }
+
+        printf("check passed\n");
+    }
+
+    return 0;
+}
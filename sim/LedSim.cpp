@@ -0,0 +1,594 @@
+#include "LedBus.h"
+#include "LedDriver.h"
+#include "stdint.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+/***********************************************************************
+ * LED Fleet Simulator
+ *
+ * Drives many independent LED banks through the driver under a virtual
+ * clock. Every bank gets its own register, its own workload generator
+ * and its own emulated bus (LedBus). A hardware write occupies the bus
+ * for its latency plus transfer time plus jitter, so requests queue
+ * behind each other and the per-request latency is the time from arrival
+ * until the register write completes.
+ *
+ * All randomness, bus jitter included, comes from per-bank generators
+ * seeded from --seed and
+ * events are ordered by (time, bank), so a given command line always
+ * produces the same report. Only the host wall-clock figure varies.
+ *
+************************************************************************/
+
+enum Workload
+{
+    WORKLOAD_RANDOM,
+    WORKLOAD_BURST,
+    WORKLOAD_ANIMATION,
+    WORKLOAD_BAD_INDEX,
+    WORKLOAD_MIXED,
+};
+
+static const char* const workloadNames[] = { "random", "burst", "animation", "bad", "mixed" };
+
+struct SimConfig
+{
+    uint32_t banks = 10000;
+    uint64_t duration_ns = 100000000;
+    uint64_t seed = 1;
+    Workload workload = WORKLOAD_MIXED;
+    uint32_t rate_hz = 1000;
+    uint32_t write_ns = 2000;
+    uint32_t bus_bandwidth = 0;
+    uint32_t bus_frame = 2;
+    uint32_t bus_jitter_ns = 0;
+    uint32_t burst_length = 16;
+    bool per_bank = false;
+    bool check_determinism = false;
+};
+
+struct BankState
+{
+    LedDriver_Bank driver;
+    uint16_t reg;
+    Workload workload;
+    uint64_t rng;
+    LedBus bus;
+    uint32_t burst_remaining;
+    int16_t animation_led;
+    bool animation_on_phase;
+    std::vector<uint32_t> latencies;
+};
+
+struct SimResult
+{
+    uint64_t operations = 0;
+    uint64_t rejected = 0;
+    uint64_t reads = 0;
+    uint64_t hardware_writes = 0;
+    uint64_t effective_writes = 0;
+    uint64_t bus_busy_ns = 0;
+    uint64_t end_ns = 0;
+    uint64_t digest = 0;
+    double host_seconds = 0.0;
+    std::vector<uint32_t> latencies;
+    std::vector<uint32_t> bank_p99;
+};
+
+// The library reports bad indices here; the simulator only counts them
+static uint64_t runtimeErrors;
+
+extern "C" void RuntimeError(const char * m, int p, const char * f, int l)
+{
+    (void)m;
+    (void)p;
+    (void)f;
+    (void)l;
+
+    runtimeErrors++;
+}
+
+static uint64_t nextRandom(uint64_t* state)
+{
+    // xorshift64* - fixed arithmetic so results match on every host
+    uint64_t x = *state;
+
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+static uint32_t randomBelow(uint64_t* state, uint32_t limit)
+{
+    return (uint32_t)((nextRandom(state) >> 32) % limit);
+}
+
+static uint64_t mixSeed(uint64_t seed, uint64_t bank)
+{
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL * (bank + 1);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+
+    return (0 == z) ? 1 : z;
+}
+
+static uint64_t fnv1a(uint64_t hash, uint64_t value)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        hash ^= (value >> (8 * i)) & 0xFF;
+        hash *= 0x100000001B3ULL;
+    }
+
+    return hash;
+}
+
+static uint32_t percentile(const std::vector<uint32_t>& sorted, uint32_t perMille)
+{
+    if (sorted.empty())
+    {
+        return 0;
+    }
+
+    size_t index = (size_t)(((uint64_t)(sorted.size() - 1) * perMille) / 1000);
+
+    return sorted[index];
+}
+
+// Performs one driver call for the bank and returns the delay until its next one
+static uint64_t runOperation(BankState& bank, const SimConfig& config, SimResult& result, uint64_t now)
+{
+    uint64_t period = 1000000000ULL / config.rate_hz;
+    uint64_t errorsBefore = runtimeErrors;
+    uint64_t writesBefore = bank.bus.stats.writes;
+    uint16_t before = bank.reg;
+    uint32_t choice = randomBelow(&bank.rng, 100);
+    uint64_t delay;
+
+    // Register writes made by the driver calls below go through the bank's bus
+    LedBus_SetTime(&bank.bus, now);
+    LedBus_Select(&bank.bus);
+
+    switch (bank.workload)
+    {
+        case WORKLOAD_RANDOM:
+        default:
+        {
+            int16_t led = (int16_t)(1 + randomBelow(&bank.rng, 16));
+
+            if (choice < 40)
+            {
+                (void)LedDriver_BankTurnOn(&bank.driver, led);
+            }
+            else if (choice < 80)
+            {
+                (void)LedDriver_BankTurnOff(&bank.driver, led);
+            }
+            else if (choice < 90)
+            {
+                (void)LedDriver_BankIsOn(&bank.driver, led);
+                result.reads++;
+            }
+            else if (choice < 95)
+            {
+                (void)LedDriver_BankTurnOnAll(&bank.driver);
+            }
+            else
+            {
+                (void)LedDriver_BankTurnOffAll(&bank.driver);
+            }
+
+            delay = 1 + randomBelow(&bank.rng, (uint32_t)(2 * period));
+            break;
+        }
+
+        case WORKLOAD_BURST:
+        {
+            int16_t led = (int16_t)(1 + randomBelow(&bank.rng, 16));
+
+            (void)((choice < 50) ? LedDriver_BankTurnOn(&bank.driver, led)
+                                 : LedDriver_BankTurnOff(&bank.driver, led));
+
+            if (0 == bank.burst_remaining)
+            {
+                bank.burst_remaining = config.burst_length;
+            }
+
+            bank.burst_remaining--;
+
+            if (0 == bank.burst_remaining)
+            {
+                delay = 1 + randomBelow(&bank.rng, (uint32_t)(2 * period * config.burst_length));
+            }
+            else
+            {
+                delay = 1;
+            }
+            break;
+        }
+
+        case WORKLOAD_ANIMATION:
+        {
+            // Chaser: each frame switches the previous LED off and the next one on
+            if (true == bank.animation_on_phase)
+            {
+                bank.animation_led = (int16_t)((bank.animation_led % 16) + 1);
+                (void)LedDriver_BankTurnOn(&bank.driver, bank.animation_led);
+                delay = period;
+            }
+            else
+            {
+                (void)LedDriver_BankTurnOff(&bank.driver, bank.animation_led);
+                delay = 0;
+            }
+
+            bank.animation_on_phase = !bank.animation_on_phase;
+            break;
+        }
+
+        case WORKLOAD_BAD_INDEX:
+        {
+            static const int16_t badLeds[] = { -1, 0, 17, 3141 };
+            int16_t led;
+
+            if (choice < 50)
+            {
+                led = badLeds[randomBelow(&bank.rng, 4)];
+            }
+            else
+            {
+                led = (int16_t)(1 + randomBelow(&bank.rng, 16));
+            }
+
+            if (choice % 3 == 0)
+            {
+                (void)LedDriver_BankIsOn(&bank.driver, led);
+                result.reads++;
+            }
+            else if (choice % 3 == 1)
+            {
+                (void)LedDriver_BankTurnOn(&bank.driver, led);
+            }
+            else
+            {
+                (void)LedDriver_BankTurnOff(&bank.driver, led);
+            }
+
+            delay = 1 + randomBelow(&bank.rng, (uint32_t)(2 * period));
+            break;
+        }
+    }
+
+    result.operations++;
+    result.rejected += runtimeErrors - errorsBefore;
+
+    if (writesBefore != bank.bus.stats.writes)
+    {
+        bank.latencies.push_back((uint32_t)(bank.bus.free_at - now));
+
+        result.hardware_writes += bank.bus.stats.writes - writesBefore;
+
+        if (before != bank.reg)
+        {
+            result.effective_writes++;
+        }
+    }
+
+    return delay;
+}
+
+static SimResult runSimulation(const SimConfig& config)
+{
+    typedef std::pair<uint64_t, uint32_t> Event;
+
+    std::vector<BankState> banks(config.banks);
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event> > events;
+    SimResult result;
+
+    runtimeErrors = 0;
+
+    LedBus_Config bus;
+
+    bus.latency_ns = config.write_ns;
+    bus.bytes_per_second = config.bus_bandwidth;
+    bus.frame_bytes = config.bus_frame;
+    bus.jitter_ns = config.bus_jitter_ns;
+    bus.real_time = false;
+
+    for (uint32_t i = 0; i < config.banks; i++)
+    {
+        BankState& bank = banks[i];
+
+        bank.rng = mixSeed(config.seed, i);
+        bank.workload = config.workload;
+
+        if (WORKLOAD_MIXED == config.workload)
+        {
+            bank.workload = (Workload)randomBelow(&bank.rng, WORKLOAD_MIXED);
+        }
+
+        bank.reg = (uint16_t)nextRandom(&bank.rng);
+
+        bus.seed = mixSeed(~config.seed, i);
+        LedBus_Init(&bank.bus, &bus, &bank.reg, 1);
+        bank.burst_remaining = 0;
+        bank.animation_led = 0;
+        bank.animation_on_phase = true;
+
+        LedDriver_BankInit(&bank.driver, &bank.reg, (0 != (i & 1)), (0 != (i & 2)));
+
+        events.push(Event(randomBelow(&bank.rng, 1000000000U / config.rate_hz), i));
+    }
+
+    std::chrono::steady_clock::time_point hostStart = std::chrono::steady_clock::now();
+
+    while ((false == events.empty()) && (events.top().first < config.duration_ns))
+    {
+        Event event = events.top();
+        events.pop();
+
+        uint64_t delay = runOperation(banks[event.second], config, result, event.first);
+
+        result.end_ns = event.first;
+        events.push(Event(event.first + delay, event.second));
+    }
+
+    std::chrono::duration<double> hostElapsed = std::chrono::steady_clock::now() - hostStart;
+
+    LedBus_Select(NULL);
+    result.host_seconds = hostElapsed.count();
+
+    uint64_t digest = 0xCBF29CE484222325ULL;
+
+    for (BankState& bank : banks)
+    {
+        std::sort(bank.latencies.begin(), bank.latencies.end());
+        result.bank_p99.push_back(percentile(bank.latencies, 990));
+        result.latencies.insert(result.latencies.end(), bank.latencies.begin(), bank.latencies.end());
+
+        result.bus_busy_ns += bank.bus.stats.busy_ns;
+
+        digest = fnv1a(digest, bank.reg);
+        digest = fnv1a(digest, bank.latencies.size());
+    }
+
+    digest = fnv1a(digest, result.operations);
+    digest = fnv1a(digest, result.rejected);
+    digest = fnv1a(digest, result.hardware_writes);
+    digest = fnv1a(digest, result.effective_writes);
+
+    std::sort(result.latencies.begin(), result.latencies.end());
+
+    for (uint32_t latency : result.latencies)
+    {
+        digest = fnv1a(digest, latency);
+    }
+
+    result.digest = digest;
+
+    return result;
+}
+
+static void printReport(const SimConfig& config, const SimResult& result)
+{
+    std::vector<uint32_t> bankP99(result.bank_p99);
+    double virtualSeconds = (double)config.duration_ns / 1e9;
+
+    printf("LedDriver fleet simulation\n");
+    printf("  banks                %u\n", config.banks);
+    printf("  workload             %s\n", workloadNames[config.workload]);
+    printf("  seed                 %llu\n", (unsigned long long)config.seed);
+    printf("  virtual time         %.3f ms\n", virtualSeconds * 1e3);
+    printf("  write cost           %u ns", config.write_ns);
+
+    if (0 != config.bus_bandwidth)
+    {
+        printf(" + %u bytes at %u B/s", config.bus_frame, config.bus_bandwidth);
+    }
+
+    if (0 != config.bus_jitter_ns)
+    {
+        printf(" + up to %u ns jitter", config.bus_jitter_ns);
+    }
+
+    printf("\n");
+    printf("  operations           %llu\n", (unsigned long long)result.operations);
+    printf("  reads                %llu\n", (unsigned long long)result.reads);
+    printf("  rejected (bad index) %llu\n", (unsigned long long)result.rejected);
+    printf("  hardware writes      %llu\n", (unsigned long long)result.hardware_writes);
+    printf("  effective writes     %llu\n", (unsigned long long)result.effective_writes);
+
+    if (0 != result.effective_writes)
+    {
+        printf("  write amplification  %.3f\n", (double)result.hardware_writes / (double)result.effective_writes);
+    }
+    else
+    {
+        printf("  write amplification  n/a\n");
+    }
+
+    printf("  bus utilisation      %.2f %%\n",
+           (100.0 * (double)result.bus_busy_ns) / ((double)config.banks * (double)config.duration_ns));
+    printf("  throughput (virtual) %.0f ops/s\n", (double)result.operations / virtualSeconds);
+
+    if (0.0 < result.host_seconds)
+    {
+        printf("  throughput (host)    %.0f ops/s\n", (double)result.operations / result.host_seconds);
+    }
+
+    printf("  latency ns           p50 %u  p99 %u  p99.9 %u  max %u\n",
+           percentile(result.latencies, 500),
+           percentile(result.latencies, 990),
+           percentile(result.latencies, 999),
+           result.latencies.empty() ? 0 : result.latencies.back());
+    std::sort(bankP99.begin(), bankP99.end());
+
+    printf("  per-bank p99 ns      min %u  p50 %u  p99 %u  max %u\n",
+           bankP99.empty() ? 0 : bankP99.front(),
+           percentile(bankP99, 500),
+           percentile(bankP99, 990),
+           bankP99.empty() ? 0 : bankP99.back());
+    printf("  digest               0x%016llx\n", (unsigned long long)result.digest);
+}
+
+static void printUsage(const char* program)
+{
+    printf("usage: %s [options]\n", program);
+    printf("  --banks N          number of LED banks (default 10000)\n");
+    printf("  --duration-ms N    virtual run time in milliseconds (default 100)\n");
+    printf("  --seed N           generator seed (default 1)\n");
+    printf("  --workload NAME    random | burst | animation | bad | mixed (default mixed)\n");
+    printf("  --rate-hz N        mean operations per bank per second (default 1000)\n");
+    printf("  --write-ns N       fixed bus latency of one register write (default 2000)\n");
+    printf("  --bus-bandwidth N  bus bytes per second, 0 for unlimited (default 0)\n");
+    printf("  --bus-frame N      bytes sent per register write (default 2)\n");
+    printf("  --bus-jitter-ns N  extra write cost drawn from 0..N (default 0)\n");
+    printf("  --burst N          operations per burst (default 16)\n");
+    printf("  --per-bank         print the p99 latency of every bank\n");
+    printf("  --check            run twice and fail if the results differ\n");
+}
+
+static bool parseArguments(int argc, char** argv, SimConfig& config)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (0 == strcmp(arg, "--per-bank"))
+        {
+            config.per_bank = true;
+            continue;
+        }
+
+        if (0 == strcmp(arg, "--check"))
+        {
+            config.check_determinism = true;
+            continue;
+        }
+
+        if (NULL == value)
+        {
+            return false;
+        }
+
+        i++;
+
+        if (0 == strcmp(arg, "--banks"))
+        {
+            config.banks = (uint32_t)strtoul(value, NULL, 10);
+        }
+        else if (0 == strcmp(arg, "--duration-ms"))
+        {
+            config.duration_ns = strtoull(value, NULL, 10) * 1000000ULL;
+        }
+        else if (0 == strcmp(arg, "--seed"))
+        {
+            config.seed = strtoull(value, NULL, 10);
+        }
+        else if (0 == strcmp(arg, "--rate-hz"))
+        {
+            config.rate_hz = (uint32_t)strtoul(value, NULL, 10);
+        }
+        else if (0 == strcmp(arg, "--write-ns"))
+        {
+            config.write_ns = (uint32_t)strtoul(value, NULL, 10);
+        }
+        else if (0 == strcmp(arg, "--bus-bandwidth"))
+        {
+            config.bus_bandwidth = (uint32_t)strtoul(value, NULL, 10);
+        }
+        else if (0 == strcmp(arg, "--bus-frame"))
+        {
+            config.bus_frame = (uint32_t)strtoul(value, NULL, 10);
+        }
+        else if (0 == strcmp(arg, "--bus-jitter-ns"))
+        {
+            config.bus_jitter_ns = (uint32_t)strtoul(value, NULL, 10);
+        }
+        else if (0 == strcmp(arg, "--burst"))
+        {
+            config.burst_length = (uint32_t)strtoul(value, NULL, 10);
+        }
+        else if (0 == strcmp(arg, "--workload"))
+        {
+            bool found = false;
+
+            for (int w = 0; w <= WORKLOAD_MIXED; w++)
+            {
+                if (0 == strcmp(value, workloadNames[w]))
+                {
+                    config.workload = (Workload)w;
+                    found = true;
+                }
+            }
+
+            if (false == found)
+            {
+                return false;
+            }
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return (0 != config.banks) && (0 != config.rate_hz) && (0 != config.burst_length)
+        && (1000000000U / config.rate_hz >= 1);
+}
+
+int main(int argc, char** argv)
+{
+    SimConfig config;
+
+    if (false == parseArguments(argc, argv, config))
+    {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    SimResult result = runSimulation(config);
+
+    printReport(config, result);
+
+    if (true == config.per_bank)
+    {
+        printf("\n  bank  p99 ns\n");
+
+        for (size_t i = 0; i < result.bank_p99.size(); i++)
+        {
+            printf("  %4zu  %u\n", i, result.bank_p99[i]);
+        }
+    }
+
+    if (true == config.check_determinism)
+    {
+        SimResult again = runSimulation(config);
+
+        if (again.digest != result.digest)
+        {
+            printf("determinism check FAILED: 0x%016llx != 0x%016llx\n",
+                   (unsigned long long)again.digest, (unsigned long long)result.digest);
+            return 1;
+        }
+
+        printf("determinism check passed\n");
+    }
+
+    return 0;
+}
@@ -3,11 +3,13 @@ static const char* message = "No Error";
 static int parameter = -1;
 static const char * file = 0;
 static int line = -1;
+static int count = 0;
 
 void RuntimeErrorStub_Reset(void)
 {
     message = "No Error";
     parameter = -1;
+    count = 0;
 }
 
 const char* RuntimeErrorStub_GetLastError(void)
@@ -21,9 +23,15 @@ void RuntimeError(const char * m, int p, const char * f, int l)
     parameter = p;
     file = f;
     line = l;
+    count++;
 }
 
 int RuntimeErrorStub_GetLastParameter(void)
 {
     return parameter;
+}
+
+int RuntimeErrorStub_GetCount(void)
+{
+    return count;
 }
\ No newline at end of file
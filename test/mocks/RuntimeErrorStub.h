@@ -12,6 +12,9 @@ const char* RuntimeErrorStub_GetLastError(void);
 
 int RuntimeErrorStub_GetLastParameter(void);
 
+// Errors reported since the last reset
+int RuntimeErrorStub_GetCount(void);
+
 // Catch2 is a C++ test framework, to link a C library you need these tags
 #ifdef __cplusplus
 }
@@ -27,6 +27,9 @@
  * 16. Read Off out-of-bounds - LEDs are always off
  * 17. Invert LED Output.
  * 18. Null Initialise protection
+ * 19. Independent banks
+ * 20. Masked update of many LEDs with one write
+ * 21. Arbitrary logical to physical LED order
  * 
 ************************************************************************/
 
@@ -700,4 +703,196 @@ TEST_F(LedDriver_Operation_NotInitialised, IsOff)
     ASSERT_TRUE( true == LedDriver_IsOff(11) );
     ASSERT_TRUE( -1 == LedDriver_TurnOn(11) );
     ASSERT_TRUE( true == LedDriver_IsOff(11) );
+}
+
+class LedDriver_Banks : public ::testing::Test 
+{
+    protected:
+        LedDriver_Bank first;
+        LedDriver_Bank second;
+        uint16_t firstLEDs;
+        uint16_t secondLEDs;
+
+        virtual void SetUp() 
+        {
+            firstLEDs = 0xFFFF;
+            secondLEDs = 0x0000;
+            LedDriver_BankInit(&first, &firstLEDs, false, false);
+            LedDriver_BankInit(&second, &secondLEDs, true, false);
+        }
+
+        virtual void TearDown()
+        {
+            // tear down code
+        }
+};
+
+//TEST_F(LedDriver_Banks, "19. Banks are initialised independently")
+TEST_F(LedDriver_Banks, 19BanksAreInitialisedIndependently)
+{
+    ASSERT_EQ( firstLEDs, 0x0000 );
+    ASSERT_EQ( secondLEDs, 0xFFFF );
+}
+
+//TEST_F(LedDriver_Banks, "19. Banks are driven independently")
+TEST_F(LedDriver_Banks, 19BanksAreDrivenIndependently)
+{
+    LedDriver_BankTurnOn(&first, 1);
+    LedDriver_BankTurnOn(&second, 8);
+
+    ASSERT_EQ( firstLEDs, 0x0001 );
+    ASSERT_EQ( secondLEDs, 0xFF7F );
+    ASSERT_TRUE( LedDriver_BankIsOn(&first, 1) );
+    ASSERT_TRUE( LedDriver_BankIsOff(&first, 8) );
+    ASSERT_TRUE( LedDriver_BankIsOn(&second, 8) );
+}
+
+//TEST_F(LedDriver_Banks, "19. Banks do not disturb the default driver")
+TEST_F(LedDriver_Banks, 19BanksDoNotDisturbTheDefaultDriver)
+{
+    VirtualLEDs = 0xFFFF;
+    LedDriver_Init(&VirtualLEDs, false, false);
+
+    LedDriver_BankTurnOnAll(&first);
+
+    ASSERT_EQ( VirtualLEDs, 0x0000 );
+    ASSERT_EQ( firstLEDs, 0xFFFF );
+}
+
+TEST( LedDriver_Banks_NotInitialised, NullBank )
+{
+    ASSERT_EQ( LedDriver_BankInit(NULL, &VirtualLEDs, false, false), -1 );
+    ASSERT_EQ( LedDriver_BankTurnOn(NULL, 1), -1 );
+    ASSERT_EQ( LedDriver_BankTurnOffAll(NULL), -1 );
+    ASSERT_TRUE( LedDriver_BankIsOff(NULL, 1) );
+}
+
+//TEST_F(LedDriver_Banks, "20. Masked update turns LEDs on and off")
+TEST_F(LedDriver_Banks, 20MaskedUpdateTurnsLEDsOnAndOff)
+{
+    LedDriver_BankTurnOn(&first, 16);
+
+    ASSERT_EQ( LedDriver_BankUpdate(&first, 0x0005, 0x8000), 0 );
+    ASSERT_EQ( firstLEDs, 0x0005 );
+
+    ASSERT_EQ( LedDriver_BankUpdate(&second, 0x0081, 0x0000), 0 );
+    ASSERT_EQ( secondLEDs, 0xFF7E );
+}
+
+//TEST_F(LedDriver_Banks, "20. Masked update follows inverted input")
+TEST_F(LedDriver_Banks, 20MaskedUpdateFollowsInvertedInput)
+{
+    LedDriver_BankInit(&first, &firstLEDs, false, true);
+
+    LedDriver_BankUpdate(&first, 0x0081, 0x0000);
+
+    ASSERT_EQ( firstLEDs, 0x8100 );
+    ASSERT_TRUE( LedDriver_BankIsOn(&first, 1) );
+    ASSERT_TRUE( LedDriver_BankIsOn(&first, 8) );
+}
+
+//TEST_F(LedDriver_Banks, "20. Turn on wins when an LED is in both masks")
+TEST_F(LedDriver_Banks, 20TurnOnWinsWhenInBothMasks)
+{
+    LedDriver_BankUpdate(&first, 0x0003, 0x0006);
+
+    ASSERT_EQ( firstLEDs, 0x0003 );
+}
+
+TEST( LedDriver_Banks_NotInitialised, MaskedUpdate )
+{
+    LedDriver_Bank bank;
+
+    LedDriver_BankInit(&bank, NULL, false, false);
+
+    ASSERT_EQ( LedDriver_BankUpdate(&bank, 0xFFFF, 0x0000), -1 );
+    ASSERT_EQ( LedDriver_BankUpdate(NULL, 0xFFFF, 0x0000), -1 );
+}
+
+class LedDriver_Mapped : public ::testing::Test 
+{
+    protected:
+        LedDriver_Bank bank;
+        LedDriver_Map map;
+        uint16_t mappedLEDs;
+
+        virtual void SetUp() 
+        {
+            // LED n drives bit (n * 5) mod 16
+            uint8_t physical[16];
+
+            for (int i = 0; i < 16; i++)
+            {
+                physical[i] = (uint8_t)(((i + 1) * 5) % 16);
+            }
+
+            ASSERT_EQ( LedDriver_MapInit(&map, physical), 0 );
+
+            mappedLEDs = 0xFFFF;
+            LedDriver_BankInitMapped(&bank, &mappedLEDs, false, &map);
+        }
+
+        virtual void TearDown()
+        {
+            // tear down code
+        }
+};
+
+//TEST_F(LedDriver_Mapped, "21. Single LEDs follow the map")
+TEST_F(LedDriver_Mapped, 21SingleLEDsFollowTheMap)
+{
+    ASSERT_EQ( mappedLEDs, 0x0000 );
+
+    LedDriver_BankTurnOn(&bank, 1);
+    ASSERT_EQ( mappedLEDs, 0x0020 );
+
+    LedDriver_BankTurnOn(&bank, 16);
+    ASSERT_EQ( mappedLEDs, 0x0021 );
+
+    ASSERT_TRUE( LedDriver_BankIsOn(&bank, 16) );
+    ASSERT_TRUE( LedDriver_BankIsOff(&bank, 2) );
+}
+
+//TEST_F(LedDriver_Mapped, "21. Masks follow the map")
+TEST_F(LedDriver_Mapped, 21MasksFollowTheMap)
+{
+    ASSERT_EQ( LedDriver_BankMapLeds(&bank, 0x8003), 0x0421 );
+
+    LedDriver_BankUpdate(&bank, 0x8003, 0x0000);
+
+    ASSERT_EQ( mappedLEDs, 0x0421 );
+}
+
+//TEST_F(LedDriver_Mapped, "21. Inverted output still applies")
+TEST_F(LedDriver_Mapped, 21InvertedOutputStillApplies)
+{
+    LedDriver_BankInitMapped(&bank, &mappedLEDs, true, &map);
+
+    LedDriver_BankTurnOn(&bank, 2);
+
+    ASSERT_EQ( mappedLEDs, 0xFBFF );
+}
+
+TEST( LedDriver_Map, 21MapMustUseEveryBitOnce )
+{
+    LedDriver_Map map;
+    uint8_t physical[16] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 14 };
+
+    ASSERT_EQ( LedDriver_MapInit(&map, physical), -1 );
+
+    physical[15] = 16;
+    ASSERT_EQ( LedDriver_MapInit(&map, physical), -1 );
+
+    physical[15] = 15;
+    ASSERT_EQ( LedDriver_MapInit(&map, physical), 0 );
+
+    ASSERT_EQ( LedDriver_MapInit(NULL, physical), -1 );
+    ASSERT_EQ( LedDriver_MapInit(&map, NULL), -1 );
+}
+
+TEST( LedDriver_Map, 21BankNeedsAMap )
+{
+    LedDriver_Bank bank;
+
+    ASSERT_EQ( LedDriver_BankInitMapped(&bank, &VirtualLEDs, false, NULL), -1 );
 }
\ No newline at end of file
@@ -0,0 +1,298 @@
+#include <gtest/gtest.h>
+#include "LedBus.h"
+#include "stdint.h"
+
+#include <thread>
+
+/***********************************************************************
+ * LED Bus Test
+ *
+ * Requirements:
+ * 1. A write stores the value and completes after the bus latency
+ * 2. A write issued while the bus is busy waits for the previous one
+ * 3. The bandwidth limit adds the frame transfer time, rounded up
+ * 4. Jitter stays within its bound and repeats for the same seed
+ * 5. Writes of an unchanged value are counted as redundant
+ * 6. Only registers of the selected bus are routed through it
+ * 7. In real time a write blocks for its cost
+ * 8. A burst pays the latency once and two bytes per extra register
+ * 9. A burst with nothing to write is refused
+ * 10. The selection holds for every thread, which take the bus in turn
+ * 11. Registers change in the order their writes were booked
+ *
+************************************************************************/
+
+class LedBus_Operation : public ::testing::Test
+{
+    protected:
+        LedBus bus;
+        LedBus_Config config;
+        uint16_t registers[5];
+
+        virtual void SetUp()
+        {
+            config.latency_ns = 1000;
+            config.bytes_per_second = 0;
+            config.frame_bytes = 0;
+            config.jitter_ns = 0;
+            config.seed = 1;
+            config.real_time = false;
+
+            registers[0] = 0;
+            registers[1] = 0;
+            registers[2] = 0;
+            registers[3] = 0;
+            registers[4] = 0;
+
+            // The last register is not on the bus
+            ASSERT_EQ( LedBus_Init(&bus, &config, registers, 4), 0 );
+        }
+
+        virtual void TearDown()
+        {
+            LedBus_Select(NULL);
+        }
+};
+
+//TEST_F(LedBus_Operation, "1. A write stores the value and completes after the bus latency")
+TEST_F(LedBus_Operation, 1WriteCompletesAfterLatency)
+{
+    LedBus_SetTime(&bus, 5000);
+
+    ASSERT_EQ( LedBus_Write(&bus, &registers[0], 0x1234), 6000u );
+    ASSERT_EQ( registers[0], 0x1234 );
+    ASSERT_EQ( bus.stats.writes, 1u );
+    ASSERT_EQ( bus.stats.bytes, 2u );
+    ASSERT_EQ( bus.stats.busy_ns, 1000u );
+}
+
+//TEST_F(LedBus_Operation, "2. A write issued while the bus is busy waits for the previous one")
+TEST_F(LedBus_Operation, 2BusyBusQueuesWrites)
+{
+    LedBus_Stats stats;
+
+    LedBus_SetTime(&bus, 0);
+
+    ASSERT_EQ( LedBus_Write(&bus, &registers[0], 1), 1000u );
+    ASSERT_EQ( LedBus_Write(&bus, &registers[1], 1), 2000u );
+
+    LedBus_SetTime(&bus, 5000);
+
+    ASSERT_EQ( LedBus_Write(&bus, &registers[2], 1), 6000u );
+
+    LedBus_GetStats(&bus, &stats);
+
+    ASSERT_EQ( stats.writes, 3u );
+    ASSERT_EQ( stats.queued_ns, 1000u );
+}
+
+//TEST_F(LedBus_Operation, "3. The bandwidth limit adds the frame transfer time, rounded up")
+TEST_F(LedBus_Operation, 3BandwidthAddsTransferTime)
+{
+    config.bytes_per_second = 3000000;
+    config.frame_bytes = 4;
+    LedBus_Init(&bus, &config, registers, 4);
+
+    // 4 bytes at 3 MB/s is 1333.3 ns
+    ASSERT_EQ( LedBus_Write(&bus, &registers[0], 1), 1000u + 1334u );
+    ASSERT_EQ( bus.stats.bytes, 4u );
+}
+
+//TEST_F(LedBus_Operation, "4. Jitter stays within its bound and repeats for the same seed")
+TEST_F(LedBus_Operation, 4JitterIsBoundedAndRepeatable)
+{
+    LedBus other;
+    uint64_t done;
+    uint64_t shortest = UINT64_MAX;
+    uint64_t longest = 0;
+
+    config.latency_ns = 0;
+    config.jitter_ns = 100;
+    LedBus_Init(&bus, &config, registers, 4);
+    LedBus_Init(&other, &config, registers, 4);
+
+    for (uint64_t now = 0; now < 100000; now += 1000)
+    {
+        LedBus_SetTime(&bus, now);
+        LedBus_SetTime(&other, now);
+
+        done = LedBus_Write(&bus, &registers[0], 1);
+
+        ASSERT_LE( done - now, 100u );
+        ASSERT_EQ( LedBus_Write(&other, &registers[1], 1), done );
+
+        shortest = std::min(shortest, done - now);
+        longest = std::max(longest, done - now);
+    }
+
+    ASSERT_LT( shortest, longest );
+}
+
+//TEST_F(LedBus_Operation, "5. Writes of an unchanged value are counted as redundant")
+TEST_F(LedBus_Operation, 5UnchangedWritesAreRedundant)
+{
+    LedBus_Write(&bus, &registers[0], 0x0001);
+    LedBus_Write(&bus, &registers[0], 0x0001);
+    LedBus_Write(&bus, &registers[0], 0x0003);
+    LedBus_Write(&bus, &registers[0], 0x0003);
+
+    ASSERT_EQ( bus.stats.writes, 4u );
+    ASSERT_EQ( bus.stats.redundant, 2u );
+
+    LedBus_ResetStats(&bus);
+
+    ASSERT_EQ( bus.stats.writes, 0u );
+    ASSERT_EQ( bus.stats.redundant, 0u );
+}
+
+//TEST_F(LedBus_Operation, "6. Only registers of the selected bus are routed through it")
+TEST_F(LedBus_Operation, 6StoreRoutesOwnedRegisters)
+{
+    uint16_t elsewhere = 0;
+
+    LedBus_Store(&registers[0], 1);
+
+    ASSERT_EQ( registers[0], 1 );
+    ASSERT_EQ( bus.stats.writes, 0u );
+
+    LedBus_Select(&bus);
+
+    ASSERT_EQ( LedBus_Selected(), &bus );
+
+    LedBus_Store(&registers[3], 2);
+    LedBus_Store(&elsewhere, 3);
+
+    ASSERT_EQ( registers[3], 2 );
+    ASSERT_EQ( elsewhere, 3 );
+    ASSERT_EQ( bus.stats.writes, 1u );
+    ASSERT_FALSE( LedBus_Owns(&bus, &registers[4]) );
+    ASSERT_EQ( LedBus_Init(&bus, &config, NULL, 4), -1 );
+    ASSERT_EQ( LedBus_Init(&bus, &config, registers, 0), -1 );
+}
+
+//TEST_F(LedBus_Operation, "7. In real time a write blocks for its cost")
+TEST_F(LedBus_Operation, 7RealTimeWriteBlocks)
+{
+    uint64_t start;
+
+    config.latency_ns = 200000;
+    config.real_time = true;
+    LedBus_Init(&bus, &config, registers, 4);
+
+    start = LedBus_Now();
+
+    LedBus_Write(&bus, &registers[0], 1);
+    LedBus_Write(&bus, &registers[0], 2);
+
+    ASSERT_GE( LedBus_Now() - start, 400000u );
+    ASSERT_EQ( registers[0], 2 );
+}
+
+//TEST_F(LedBus_Operation, "8. A burst pays the latency once and two bytes per extra register")
+TEST_F(LedBus_Operation, 8BurstSharesLatency)
+{
+    const uint16_t values[4] = { 1, 2, 3, 4 };
+
+    config.bytes_per_second = 1000000;
+    LedBus_Init(&bus, &config, registers, 4);
+    LedBus_Select(&bus);
+
+    // 2 byte frame plus 3 more registers at 1 us per byte
+    LedBus_StoreBurst(&registers[0], values, 4);
+
+    ASSERT_EQ( bus.free_at, 1000u + 8000u );
+    ASSERT_EQ( bus.stats.writes, 1u );
+    ASSERT_EQ( bus.stats.bytes, 8u );
+    ASSERT_EQ( registers[3], 4 );
+
+    // Running past the last register falls back to plain stores
+    LedBus_StoreBurst(&registers[1], values, 4);
+
+    ASSERT_EQ( bus.stats.writes, 1u );
+}
+
+//TEST_F(LedBus_Operation, "9. A burst with nothing to write is refused")
+TEST_F(LedBus_Operation, 9EmptyBurstIsRefused)
+{
+    const uint16_t values[1] = { 1 };
+
+    ASSERT_EQ( LedBus_WriteBurst(NULL, &registers[0], values, 1), 0u );
+    ASSERT_EQ( LedBus_WriteBurst(&bus, &registers[0], values, 0), 0u );
+    ASSERT_EQ( LedBus_WriteBurst(&bus, NULL, values, 1), 0u );
+    ASSERT_EQ( LedBus_WriteBurst(&bus, &registers[0], NULL, 1), 0u );
+
+    ASSERT_EQ( registers[0], 0 );
+    ASSERT_EQ( bus.stats.writes, 0u );
+    ASSERT_EQ( bus.free_at, 0u );
+}
+
+//TEST_F(LedBus_Operation, "10. The selection holds for every thread, which take the bus in turn")
+TEST_F(LedBus_Operation, 10SelectionIsProcessWide)
+{
+    LedBus_Select(&bus);
+
+    std::thread workers[4];
+
+    for (int t = 0; t < 4; t++)
+    {
+        workers[t] = std::thread([this, t]()
+        {
+            ASSERT_EQ( LedBus_Selected(), &bus );
+
+            for (uint16_t i = 1; i <= 1000; i++)
+            {
+                LedBus_Store(&registers[t], i);
+            }
+        });
+    }
+
+    for (int t = 0; t < 4; t++)
+    {
+        workers[t].join();
+    }
+
+    ASSERT_EQ( bus.stats.writes, 4000u );
+    ASSERT_EQ( bus.free_at, 4000u * 1000u );
+    ASSERT_EQ( registers[0], 1000 );
+    ASSERT_EQ( registers[3], 1000 );
+}
+
+//TEST_F(LedBus_Operation, "11. Registers change in the order their writes were booked")
+TEST_F(LedBus_Operation, 11StoresFollowBookingOrder)
+{
+    std::thread workers[4];
+    uint64_t last[4] = { 0, 0, 0, 0 };
+    int latest;
+
+    config.real_time = true;
+    config.latency_ns = 2000;
+    ASSERT_EQ( LedBus_Init(&bus, &config, registers, 4), 0 );
+
+    // Each thread writes its own value to one register
+    for (int t = 0; t < 4; t++)
+    {
+        workers[t] = std::thread([this, t, &last]()
+        {
+            for (int i = 0; i < 250; i++)
+            {
+                last[t] = LedBus_Write(&bus, &registers[0], (uint16_t)(t + 1));
+            }
+        });
+    }
+
+    latest = 0;
+
+    for (int t = 0; t < 4; t++)
+    {
+        workers[t].join();
+
+        if (last[t] > last[latest])
+        {
+            latest = t;
+        }
+    }
+
+    // The write booked last is the one left in the register
+    ASSERT_EQ( bus.stats.writes, 1000u );
+    ASSERT_EQ( registers[0], latest + 1 );
+}
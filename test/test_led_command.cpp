@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include "LedCommand.h"
+#include "RuntimeErrorStub.h"
+#include "stdint.h"
+#include "string.h"
+
+/***********************************************************************
+ * LED Command Test
+ *
+ * Requirements:
+ * 1. Lists and ranges are parsed into masks
+ * 2. Later commands in a batch win
+ * 3. A batch is applied with one masked update
+ * 4. Out-of-range LEDs are reported once per batch
+ * 5. Batches with syntax errors are not applied
+ * 6. Several lines run as separate batches
+ *
+************************************************************************/
+
+class LedCommand_Operation : public ::testing::Test
+{
+    protected:
+        LedDriver_Bank bank;
+        LedCommand_Batch batch;
+        uint16_t LEDs;
+
+        virtual void SetUp()
+        {
+            RuntimeErrorStub_Reset();
+            LedDriver_BankInit(&bank, &LEDs, false, false);
+        }
+
+        virtual void TearDown()
+        {
+            // tear down code
+        }
+
+        int parse(const char* text)
+        {
+            return LedCommand_Parse(text, strlen(text), &batch, NULL);
+        }
+
+        int run(const char* text)
+        {
+            return LedCommand_Run(&bank, text, strlen(text));
+        }
+};
+
+//TEST_F(LedCommand_Operation, "1. Lists and ranges are parsed into masks")
+TEST_F(LedCommand_Operation, 1ListsAndRangesAreParsed)
+{
+    ASSERT_EQ( parse("on 1-8,12"), 0 );
+    ASSERT_EQ( batch.turn_on, 0x08FF );
+    ASSERT_EQ( batch.turn_off, 0x0000 );
+
+    ASSERT_EQ( parse("  off 16 , 2 - 3\t"), 0 );
+    ASSERT_EQ( batch.turn_on, 0x0000 );
+    ASSERT_EQ( batch.turn_off, 0x8006 );
+
+    ASSERT_EQ( parse("all on"), 0 );
+    ASSERT_EQ( batch.turn_on, 0xFFFF );
+}
+
+//TEST_F(LedCommand_Operation, "2. Later commands in a batch win")
+TEST_F(LedCommand_Operation, 2LaterCommandsWin)
+{
+    ASSERT_EQ( parse("on 1-8,12; off 3"), 0 );
+    ASSERT_EQ( batch.turn_on, 0x08FB );
+    ASSERT_EQ( batch.turn_off, 0x0004 );
+
+    ASSERT_EQ( parse("on 1-8,12; off 3; all off"), 0 );
+    ASSERT_EQ( batch.turn_on, 0x0000 );
+    ASSERT_EQ( batch.turn_off, 0xFFFF );
+
+    ASSERT_EQ( parse("all off; on 4;"), 0 );
+    ASSERT_EQ( batch.turn_on, 0x0008 );
+    ASSERT_EQ( batch.turn_off, 0xFFF7 );
+}
+
+//TEST_F(LedCommand_Operation, "3. A batch is applied with one masked update")
+TEST_F(LedCommand_Operation, 3BatchIsApplied)
+{
+    LedDriver_BankTurnOn(&bank, 16);
+
+    ASSERT_EQ( run("on 1-8,12; off 3"), 0 );
+    ASSERT_EQ( LEDs, 0x88FB );
+
+    ASSERT_EQ( run("all off"), 0 );
+    ASSERT_EQ( LEDs, 0x0000 );
+}
+
+//TEST_F(LedCommand_Operation, "3. Inverted banks are honoured")
+TEST_F(LedCommand_Operation, 3InvertedBanksAreHonoured)
+{
+    LedDriver_BankInit(&bank, &LEDs, true, true);
+
+    ASSERT_EQ( run("on 1,2"), 0 );
+    ASSERT_EQ( LEDs, 0x3FFF );
+}
+
+//TEST_F(LedCommand_Operation, "4. Out-of-range LEDs are reported once per batch")
+TEST_F(LedCommand_Operation, 4OutOfRangeReportedOncePerBatch)
+{
+    ASSERT_EQ( parse("on 0, 14-20; off 30-40"), 0 );
+    ASSERT_EQ( batch.turn_on, 0xE000 );
+    ASSERT_EQ( batch.out_of_range, 16u );
+    ASSERT_EQ( batch.first_out_of_range, 0 );
+
+    ASSERT_EQ( run("on 14-20; off 30-40"), 1 );
+    ASSERT_EQ( LEDs, 0xE000 );
+    ASSERT_EQ( RuntimeErrorStub_GetCount(), 1 );
+    ASSERT_EQ( 0, strcmp("LED Command: out-of-bounds LED", RuntimeErrorStub_GetLastError()) );
+    ASSERT_EQ( RuntimeErrorStub_GetLastParameter(), 17 );
+
+    ASSERT_EQ( parse("off 99999999999"), 0 );
+    ASSERT_EQ( batch.out_of_range, 1u );
+}
+
+//TEST_F(LedCommand_Operation, "5. Batches with syntax errors are not applied")
+TEST_F(LedCommand_Operation, 5SyntaxErrorsAreNotApplied)
+{
+    const char* bad[] = { "on", "on 1,", "on 3-1", "blink 4", "all", "on 1 off 2", "on 1-", "onx 1", "on -2" };
+
+    for (const char* text : bad)
+    {
+        ASSERT_EQ( parse(text), -1 ) << text;
+        ASSERT_EQ( run(text), 1 ) << text;
+    }
+
+    ASSERT_EQ( LEDs, 0x0000 );
+    ASSERT_EQ( RuntimeErrorStub_GetCount(), 0 );
+}
+
+//TEST_F(LedCommand_Operation, "6. Several lines run as separate batches")
+TEST_F(LedCommand_Operation, 6LinesAreSeparateBatches)
+{
+    size_t consumed;
+    const char* text = "on 1-4\r\nbad\n\noff 2; on 9\n";
+
+    ASSERT_EQ( LedCommand_Parse(text, strlen(text), &batch, &consumed), 0 );
+    ASSERT_EQ( consumed, 8u );
+
+    ASSERT_EQ( run(text), 1 );
+    ASSERT_EQ( LEDs, 0x010D );
+
+    // Length is honoured without a terminator
+    ASSERT_EQ( LedCommand_Run(&bank, "all on; off 1", 6), 0 );
+    ASSERT_EQ( LEDs, 0xFFFF );
+}
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include "LedCompositor.h"
+#include "stdint.h"
+
+/***********************************************************************
+ * LED Compositor Test
+ *
+ * Requirements:
+ * 1. Nothing reaches the register before a flush
+ * 2. The highest priority owner of an LED decides its state
+ * 3. Released LEDs show the layer below, or go off
+ * 4. A flush only recomputes from the highest dirtied layer
+ * 5. Unchanged output is not written again
+ * 6. Layer limits and bad layers are refused
+ *
+************************************************************************/
+
+class LedCompositor_Operation : public ::testing::Test
+{
+    protected:
+        LedDriver_Bank bank;
+        uint16_t LEDs;
+        LedCompositor compositor;
+        int alarm;
+        int status;
+        int animation;
+
+        virtual void SetUp()
+        {
+            LedDriver_BankInit(&bank, &LEDs, false, false);
+            LedCompositor_Init(&compositor, &bank);
+
+            // Added out of priority order on purpose
+            status = LedCompositor_AddLayer(&compositor, 50);
+            animation = LedCompositor_AddLayer(&compositor, 10);
+            alarm = LedCompositor_AddLayer(&compositor, 200);
+        }
+
+        virtual void TearDown()
+        {
+            // tear down code
+        }
+};
+
+//TEST_F(LedCompositor_Operation, "1. Nothing reaches the register before a flush")
+TEST_F(LedCompositor_Operation, 1NothingBeforeFlush)
+{
+    LedCompositor_Set(&compositor, status, 0x000F, true);
+
+    ASSERT_EQ( LEDs, 0x0000 );
+
+    ASSERT_EQ( LedCompositor_Flush(&compositor), 0 );
+    ASSERT_EQ( LEDs, 0x000F );
+}
+
+//TEST_F(LedCompositor_Operation, "2. The highest priority owner of an LED decides its state")
+TEST_F(LedCompositor_Operation, 2HighestPriorityOwnerWins)
+{
+    LedCompositor_Set(&compositor, animation, 0xFFFF, true);
+    LedCompositor_Set(&compositor, status, 0x00F0, false);
+    LedCompositor_Set(&compositor, alarm, 0x0010, true);
+
+    LedCompositor_Flush(&compositor);
+
+    ASSERT_EQ( LEDs, 0xFF1F );
+}
+
+//TEST_F(LedCompositor_Operation, "3. Released LEDs show the layer below, or go off")
+TEST_F(LedCompositor_Operation, 3ReleasedLEDsShowLayerBelow)
+{
+    LedCompositor_Set(&compositor, status, 0x0003, true);
+    LedCompositor_Set(&compositor, alarm, 0x0001, false);
+    LedCompositor_Set(&compositor, alarm, 0x0100, true);
+    LedCompositor_Flush(&compositor);
+    ASSERT_EQ( LEDs, 0x0102 );
+
+    LedCompositor_Release(&compositor, alarm, 0x0101);
+    LedCompositor_Flush(&compositor);
+    ASSERT_EQ( LEDs, 0x0003 );
+}
+
+//TEST_F(LedCompositor_Operation, "4. A flush only recomputes from the highest dirtied layer")
+TEST_F(LedCompositor_Operation, 4FlushRecomputesFromHighestDirtiedLayer)
+{
+    LedCompositor_Set(&compositor, alarm, 0x0001, true);
+    LedCompositor_Flush(&compositor);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        LedCompositor_Set(&compositor, animation, (uint16_t)(1u << (i % 16)), (0 == (i & 1)));
+    }
+
+    ASSERT_EQ( compositor.dirty_rank, 2 );
+
+    LedCompositor_Flush(&compositor);
+
+    ASSERT_EQ( compositor.dirty_rank, LED_COMPOSITOR_MAX_LAYERS );
+    ASSERT_EQ( LEDs, 0x5555 );
+}
+
+//TEST_F(LedCompositor_Operation, "5. Unchanged output is not written again")
+TEST_F(LedCompositor_Operation, 5UnchangedOutputIsNotRewritten)
+{
+    LedCompositor_Set(&compositor, status, 0x0001, true);
+    LedCompositor_Flush(&compositor);
+
+    LEDs = 0xAAAA;
+    LedCompositor_Set(&compositor, animation, 0x0001, false);
+    LedCompositor_Flush(&compositor);
+
+    ASSERT_EQ( LEDs, 0xAAAA );
+}
+
+//TEST_F(LedCompositor_Operation, "6. Layer limits and bad layers are refused")
+TEST_F(LedCompositor_Operation, 6LimitsAndBadLayersAreRefused)
+{
+    for (int i = 3; i < LED_COMPOSITOR_MAX_LAYERS; i++)
+    {
+        ASSERT_EQ( LedCompositor_AddLayer(&compositor, 1), i );
+    }
+
+    ASSERT_EQ( LedCompositor_AddLayer(&compositor, 1), -1 );
+    ASSERT_EQ( LedCompositor_Set(&compositor, -1, 0x0001, true), -1 );
+    ASSERT_EQ( LedCompositor_Set(&compositor, LED_COMPOSITOR_MAX_LAYERS, 0x0001, true), -1 );
+    ASSERT_EQ( LedCompositor_Release(NULL, 0, 0x0001), -1 );
+    ASSERT_EQ( LedCompositor_Init(&compositor, NULL), -1 );
+}
+
+TEST( LedCompositor_Empty, FlushesAllOff )
+{
+    LedDriver_Bank bank;
+    LedCompositor compositor;
+    uint16_t LEDs;
+
+    LedDriver_BankInit(&bank, &LEDs, true, false);
+    LedCompositor_Init(&compositor, &bank);
+    LedDriver_BankTurnOnAll(&bank);
+
+    ASSERT_EQ( LedCompositor_Flush(&compositor), 0 );
+    ASSERT_EQ( LEDs, 0xFFFF );
+}
@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include "LedDriver.hpp"
+#include "RuntimeErrorStub.h"
+#include "stdint.h"
+#include "string.h"
+
+#include <type_traits>
+#include <utility>
+
+/***********************************************************************
+ * LED C++ Wrapper Test
+ *
+ * Requirements:
+ * 1. create() hands out initialised banks only
+ * 2. Calls report errors as results
+ * 3. Banks are move-only and a moved-from bank refuses calls
+ * 4. A transaction writes its changes once, when it ends
+ * 5. A transaction can be committed early or cancelled
+ * 6. A transaction reports out-of-range LEDs like the C API
+ *
+************************************************************************/
+
+static_assert(false == std::is_copy_constructible<led::LedBank>::value, "banks must not be copied");
+static_assert(true == std::is_nothrow_move_constructible<led::LedBank>::value, "banks must move");
+static_assert(sizeof(led::LedBank) == sizeof(LedDriver_Bank), "the handle must cost nothing");
+
+class LedCxx_Operation : public ::testing::Test
+{
+    protected:
+        led::LedBank bank;
+        uint16_t LEDs;
+
+        virtual void SetUp()
+        {
+            auto created = led::LedBank::create(&LEDs);
+
+            ASSERT_TRUE( created.has_value() );
+            bank = std::move(created).value();
+        }
+
+        virtual void TearDown()
+        {
+            // tear down code
+        }
+};
+
+//TEST_F(LedCxx_Operation, "1. create() hands out initialised banks only")
+TEST_F(LedCxx_Operation, 1CreateHandsOutInitialisedBanks)
+{
+    const uint8_t physical[16] = { 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 };
+    LedDriver_Map map;
+    uint16_t other = 0x1234;
+
+    ASSERT_TRUE( static_cast<bool>(bank) );
+    ASSERT_EQ( LEDs, 0x0000 );
+
+    auto inverted = led::LedBank::create(&other, true, false);
+    ASSERT_TRUE( inverted );
+    ASSERT_EQ( other, 0xFFFF );
+
+    LedDriver_MapInit(&map, physical);
+    auto mapped = led::LedBank::create(&other, false, map);
+    ASSERT_TRUE( mapped );
+    ASSERT_TRUE( mapped->turnOn(1) );
+    ASSERT_EQ( other, 0x8000 );
+
+    auto missing = led::LedBank::create(nullptr);
+    ASSERT_FALSE( missing );
+    ASSERT_EQ( missing.error(), led::Error::NotInitialised );
+}
+
+//TEST_F(LedCxx_Operation, "2. Calls report errors as results")
+TEST_F(LedCxx_Operation, 2CallsReportErrorsAsResults)
+{
+    ASSERT_TRUE( bank.turnOn(2) );
+    ASSERT_TRUE( bank.isOn(2) );
+    ASSERT_TRUE( bank.update(0x0101, 0x0002) );
+    ASSERT_EQ( LEDs, 0x0101 );
+
+    led::Status status = bank.turnOff(17);
+    ASSERT_FALSE( status );
+    ASSERT_EQ( status.error(), led::Error::OutOfRange );
+
+    ASSERT_TRUE( bank.turnOnAll() );
+    ASSERT_EQ( LEDs, 0xFFFF );
+    ASSERT_TRUE( bank.turnOffAll() );
+    ASSERT_TRUE( bank.isOff(16) );
+}
+
+//TEST_F(LedCxx_Operation, "3. Banks are move-only and a moved-from bank refuses calls")
+TEST_F(LedCxx_Operation, 3MovedFromBankRefusesCalls)
+{
+    led::LedBank owner(std::move(bank));
+
+    ASSERT_FALSE( static_cast<bool>(bank) );
+    ASSERT_EQ( bank.turnOn(1).error(), led::Error::NotInitialised );
+    ASSERT_FALSE( bank.isOn(1) );
+    ASSERT_EQ( LEDs, 0x0000 );
+
+    ASSERT_TRUE( owner.turnOn(1) );
+    ASSERT_EQ( LEDs, 0x0001 );
+    ASSERT_EQ( owner.raw()->address, &LEDs );
+}
+
+//TEST_F(LedCxx_Operation, "4. A transaction writes its changes once, when it ends")
+TEST_F(LedCxx_Operation, 4TransactionWritesOnce)
+{
+    (void)bank.turnOn(16);
+
+    {
+        led::LedTransaction transaction(bank);
+
+        ASSERT_TRUE( transaction.turnOn(1) );
+        ASSERT_TRUE( transaction.turnOn(3) );
+        ASSERT_TRUE( transaction.turnOff(16) );
+        ASSERT_TRUE( transaction.turnOff(1) );
+        ASSERT_EQ( transaction.turnOn(0).error(), led::Error::OutOfRange );
+
+        ASSERT_EQ( LEDs, 0x8000 );
+    }
+
+    ASSERT_EQ( LEDs, 0x0004 );
+}
+
+//TEST_F(LedCxx_Operation, "5. A transaction can be committed early or cancelled")
+TEST_F(LedCxx_Operation, 5TransactionCommitsEarlyOrCancels)
+{
+    {
+        led::LedTransaction transaction(bank);
+
+        transaction.turnOnAll();
+        (void)transaction.turnOff(8);
+        ASSERT_TRUE( transaction.commit() );
+        ASSERT_EQ( LEDs, 0xFF7F );
+
+        // Nothing further is written at the end of the scope
+        LEDs = 0;
+    }
+
+    ASSERT_EQ( LEDs, 0x0000 );
+
+    {
+        led::LedTransaction transaction(bank);
+
+        transaction.turnOffAll();
+        transaction.cancel();
+    }
+
+    ASSERT_TRUE( bank.isOn(1) );
+
+    led::LedBank empty;
+    led::LedTransaction transaction(empty);
+
+    (void)transaction.turnOn(1);
+    ASSERT_EQ( transaction.commit().error(), led::Error::NotInitialised );
+}
+
+//TEST_F(LedCxx_Operation, "6. A transaction reports out-of-range LEDs like the C API")
+TEST_F(LedCxx_Operation, 6TransactionReportsOutOfRange)
+{
+    led::LedTransaction transaction(bank);
+
+    RuntimeErrorStub_Reset();
+
+    ASSERT_EQ( transaction.turnOn(17).error(), led::Error::OutOfRange );
+    ASSERT_EQ( RuntimeErrorStub_GetCount(), 1 );
+    ASSERT_EQ( 0, strcmp("LED Driver: out-of-bounds LED", RuntimeErrorStub_GetLastError()) );
+    ASSERT_EQ( RuntimeErrorStub_GetLastParameter(), 17 );
+
+    ASSERT_EQ( transaction.turnOff(0).error(), led::Error::OutOfRange );
+    ASSERT_EQ( RuntimeErrorStub_GetCount(), 2 );
+    ASSERT_EQ( RuntimeErrorStub_GetLastParameter(), 0 );
+
+    ASSERT_TRUE( transaction.turnOn(3) );
+    ASSERT_EQ( RuntimeErrorStub_GetCount(), 2 );
+    ASSERT_TRUE( transaction.commit() );
+    ASSERT_EQ( LEDs, 0x0004 );
+}
@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+#include "LedFleet.h"
+#include "stdint.h"
+
+#include <vector>
+
+/***********************************************************************
+ * LED Fleet Test
+ *
+ * Requirements:
+ * 1. Apply needs a running pool
+ * 2. Every bank in a batch is updated before Apply returns
+ * 3. Uninitialised banks are skipped and not counted
+ * 4. Idle workers steal from busy ones
+ * 5. The pool can be stopped and restarted
+ * 6. A refused Start leaves a running pool usable
+ *
+************************************************************************/
+
+class LedFleet_Operation : public ::testing::Test
+{
+    protected:
+        static const uint32_t BANKS = 1000;
+
+        std::vector<LedDriver_Bank> banks;
+        std::vector<uint16_t> registers;
+        std::vector<LedFleet_Op> ops;
+
+        virtual void SetUp()
+        {
+            banks.resize(BANKS);
+            registers.assign(BANKS, 0xFFFF);
+            ops.resize(BANKS);
+
+            for (uint32_t i = 0; i < BANKS; i++)
+            {
+                LedDriver_BankInit(&banks[i], &registers[i], (0 != (i & 1)), false);
+
+                ops[i].bank = &banks[i];
+                ops[i].turn_on = (uint16_t)(1u << (i % 16));
+                ops[i].turn_off = 0;
+            }
+
+            ASSERT_EQ( LedFleet_Start(4), 0 );
+        }
+
+        virtual void TearDown()
+        {
+            LedFleet_Stop();
+        }
+};
+
+TEST( LedFleet_NotStarted, 1ApplyNeedsRunningPool )
+{
+    LedFleet_Op op = { NULL, 0, 0 };
+
+    ASSERT_EQ( LedFleet_Apply(&op, 1), -1 );
+    ASSERT_EQ( LedFleet_Start(0), -1 );
+    ASSERT_EQ( LedFleet_Start(LED_FLEET_MAX_THREADS + 1), -1 );
+}
+
+//TEST_F(LedFleet_Operation, "1. Starting twice is refused")
+TEST_F(LedFleet_Operation, 1StartingTwiceIsRefused)
+{
+    ASSERT_EQ( LedFleet_Start(2), -1 );
+}
+
+//TEST_F(LedFleet_Operation, "4. Idle workers steal from busy ones")
+TEST_F(LedFleet_Operation, 4IdleWorkersSteal)
+{
+    const uint32_t count = 16384;
+    std::vector<LedDriver_Bank> skewed(count);
+    std::vector<uint16_t> skewedRegisters(count, 0);
+    std::vector<LedFleet_Op> skewedOps(count);
+    LedFleet_Stats stats;
+
+    // Only the first worker's share has banks to update, the other shares
+    // are skipped at once and leave their workers idle
+    for (uint32_t i = 0; i < count; i++)
+    {
+        skewedOps[i].bank = NULL;
+        skewedOps[i].turn_on = 0x0001;
+        skewedOps[i].turn_off = 0;
+
+        if (i < (count / 4))
+        {
+            ASSERT_EQ( LedDriver_BankInit(&skewed[i], &skewedRegisters[i], false, false), 0 );
+            skewedOps[i].bank = &skewed[i];
+        }
+    }
+
+    stats.steals = 0;
+
+    for (int batch = 0; (batch < 100) && (0 == stats.steals); batch++)
+    {
+        ASSERT_EQ( LedFleet_Apply(skewedOps.data(), count), (int)(count / 4) );
+        LedFleet_GetStats(&stats);
+    }
+
+    ASSERT_NE( stats.steals, 0u );
+    ASSERT_EQ( skewedRegisters[0], 0x0001 );
+    ASSERT_EQ( skewedRegisters[(count / 4) - 1], 0x0001 );
+}
+
+//TEST_F(LedFleet_Operation, "2. Every bank in a batch is updated before Apply returns")
+TEST_F(LedFleet_Operation, 2EveryBankIsUpdated)
+{
+    ASSERT_EQ( LedFleet_Apply(ops.data(), BANKS), (int)BANKS );
+
+    for (uint32_t i = 0; i < BANKS; i++)
+    {
+        uint16_t expected = (uint16_t)(1u << (i % 16));
+
+        if (0 != (i & 1))
+        {
+            expected = (uint16_t)~expected;
+        }
+
+        ASSERT_EQ( registers[i], expected );
+    }
+}
+
+//TEST_F(LedFleet_Operation, "2. Repeated batches build on each other")
+TEST_F(LedFleet_Operation, 2RepeatedBatchesBuildOnEachOther)
+{
+    LedFleet_Apply(ops.data(), BANKS);
+
+    for (uint32_t i = 0; i < BANKS; i++)
+    {
+        ops[i].turn_on = 0x8000;
+        ops[i].turn_off = 0x0001;
+    }
+
+    ASSERT_EQ( LedFleet_Apply(ops.data(), BANKS), (int)BANKS );
+
+    ASSERT_TRUE( LedDriver_BankIsOff(&banks[0], 1) );
+    ASSERT_TRUE( LedDriver_BankIsOn(&banks[0], 16) );
+    ASSERT_TRUE( LedDriver_BankIsOn(&banks[5], 6) );
+    ASSERT_TRUE( LedDriver_BankIsOn(&banks[5], 16) );
+}
+
+//TEST_F(LedFleet_Operation, "3. Uninitialised banks are skipped and not counted")
+TEST_F(LedFleet_Operation, 3UninitialisedBanksAreSkipped)
+{
+    LedDriver_BankInit(&banks[10], NULL, false, false);
+    ops[20].bank = NULL;
+
+    ASSERT_EQ( LedFleet_Apply(ops.data(), BANKS), (int)BANKS - 2 );
+    ASSERT_EQ( LedFleet_Apply(ops.data(), 0), 0 );
+}
+
+//TEST_F(LedFleet_Operation, "4. Batches smaller than a chunk per worker are still completed")
+TEST_F(LedFleet_Operation, 4SmallBatchesComplete)
+{
+    LedFleet_Stats stats;
+
+    for (uint32_t count = 1; count < 3 * LED_FLEET_CHUNK; count += 7)
+    {
+        ASSERT_EQ( LedFleet_Apply(ops.data(), count), (int)count );
+    }
+
+    LedFleet_GetStats(&stats);
+
+    ASSERT_EQ( stats.threads, 4u );
+    ASSERT_EQ( stats.batches, 14u );
+}
+
+//TEST_F(LedFleet_Operation, "5. The pool can be stopped and restarted")
+TEST_F(LedFleet_Operation, 5StopAndRestart)
+{
+    LedFleet_Stop();
+
+    ASSERT_EQ( LedFleet_Apply(ops.data(), BANKS), -1 );
+    ASSERT_EQ( LedFleet_Start(2), 0 );
+    ASSERT_EQ( LedFleet_Apply(ops.data(), BANKS), (int)BANKS );
+}
+
+//TEST_F(LedFleet_Operation, "6. A refused Start leaves a running pool usable")
+TEST_F(LedFleet_Operation, 6RefusedStartKeepsPool)
+{
+    LedFleet_Stats stats;
+
+    ASSERT_EQ( LedFleet_Start(2), -1 );
+    ASSERT_EQ( LedFleet_Start(0), -1 );
+    ASSERT_EQ( LedFleet_Start(LED_FLEET_MAX_THREADS + 1), -1 );
+
+    LedFleet_GetStats(&stats);
+
+    ASSERT_EQ( stats.threads, 4u );
+    ASSERT_EQ( LedFleet_Apply(ops.data(), BANKS), (int)BANKS );
+}
@@ -0,0 +1,293 @@
+#include <gtest/gtest.h>
+#include "LedFlush.h"
+#include "stdint.h"
+
+/***********************************************************************
+ * LED Flush Scheduler Test
+ *
+ * Requirements:
+ * 1. Driver writes are held until Service
+ * 2. Banks are flushed earliest deadline first
+ * 3. Dirty banks on adjacent registers are written as one burst
+ * 4. A burst stops at a clean register
+ * 5. Writes after the deadline are counted as missed
+ * 6. Changes undone before the flush are not written
+ * 7. Detach writes pending changes and restores direct writes
+ * 8. Many banks flush in deadline order
+ * 9. Bad arguments and repeated registers are rejected
+ * 10. A burst leaves out neighbours changed back while queued
+ *
+************************************************************************/
+
+#define REGISTERS 64
+
+class LedFlush_Operation : public ::testing::Test
+{
+    protected:
+        uint16_t registers[REGISTERS];
+        LedDriver_Bank bank[REGISTERS];
+        LedFlush flush;
+
+        virtual void SetUp()
+        {
+            ASSERT_EQ( LedFlush_Init(&flush), 0 );
+
+            for (int i = 0; i < REGISTERS; i++)
+            {
+                LedDriver_BankInit(&bank[i], &registers[i], false, false);
+            }
+        }
+
+        virtual void TearDown()
+        {
+            // tear down code
+        }
+
+        // Which of the given banks have reached their register
+        uint32_t writtenMask(int Count)
+        {
+            uint32_t mask = 0;
+
+            for (int i = 0; i < Count; i++)
+            {
+                if (0 != registers[i])
+                {
+                    mask |= 1u << i;
+                }
+            }
+
+            return mask;
+        }
+};
+
+//TEST_F(LedFlush_Operation, "1. Driver writes are held until Service")
+TEST_F(LedFlush_Operation, 1WritesAreHeldUntilService)
+{
+    LedFlush_Stats stats;
+
+    ASSERT_EQ( LedFlush_Add(&flush, &bank[0], 10), 0 );
+
+    LedDriver_BankTurnOn(&bank[0], 1);
+    LedDriver_BankTurnOn(&bank[0], 2);
+
+    ASSERT_EQ( registers[0], 0x0000 );
+    ASSERT_EQ( LedFlush_Service(&flush, 0, 8), 1 );
+    ASSERT_EQ( registers[0], 0x0003 );
+    ASSERT_EQ( LedFlush_Service(&flush, 1, 8), 0 );
+
+    LedFlush_GetStats(&flush, &stats);
+
+    ASSERT_EQ( stats.bursts, 1u );
+    ASSERT_EQ( stats.registers, 1u );
+}
+
+//TEST_F(LedFlush_Operation, "2. Banks are flushed earliest deadline first")
+TEST_F(LedFlush_Operation, 2EarliestDeadlineFirst)
+{
+    LedFlush_Add(&flush, &bank[0], 100);
+    LedFlush_Add(&flush, &bank[2], 10);
+    LedFlush_Add(&flush, &bank[4], 50);
+
+    LedDriver_BankTurnOn(&bank[0], 1);
+    LedDriver_BankTurnOn(&bank[2], 1);
+    LedDriver_BankTurnOn(&bank[4], 1);
+
+    ASSERT_EQ( LedFlush_Service(&flush, 0, 1), 1 );
+    ASSERT_EQ( writtenMask(5), 0x04u );
+    ASSERT_EQ( LedFlush_Service(&flush, 1, 1), 1 );
+    ASSERT_EQ( writtenMask(5), 0x14u );
+    ASSERT_EQ( LedFlush_Service(&flush, 2, 1), 1 );
+    ASSERT_EQ( writtenMask(5), 0x15u );
+}
+
+//TEST_F(LedFlush_Operation, "3. Dirty banks on adjacent registers are written as one burst")
+TEST_F(LedFlush_Operation, 3AdjacentRegistersAreBurst)
+{
+    LedFlush_Stats stats;
+
+    // Added out of register order on purpose
+    LedFlush_Add(&flush, &bank[2], 10);
+    LedFlush_Add(&flush, &bank[0], 10);
+    LedFlush_Add(&flush, &bank[3], 1);
+    LedFlush_Add(&flush, &bank[1], 10);
+
+    for (int i = 0; i < 4; i++)
+    {
+        LedDriver_BankTurnOn(&bank[i], (int16_t)(i + 1));
+    }
+
+    ASSERT_EQ( LedFlush_Service(&flush, 0, 1), 1 );
+    ASSERT_EQ( registers[0], 0x0001 );
+    ASSERT_EQ( registers[3], 0x0008 );
+
+    LedFlush_GetStats(&flush, &stats);
+
+    ASSERT_EQ( stats.bursts, 1u );
+    ASSERT_EQ( stats.registers, 4u );
+    ASSERT_EQ( stats.merged, 3u );
+}
+
+//TEST_F(LedFlush_Operation, "4. A burst stops at a clean register")
+TEST_F(LedFlush_Operation, 4BurstStopsAtCleanRegister)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        LedFlush_Add(&flush, &bank[i], 10);
+    }
+
+    LedDriver_BankTurnOn(&bank[0], 1);
+    LedDriver_BankTurnOn(&bank[1], 1);
+    LedDriver_BankTurnOn(&bank[3], 1);
+
+    ASSERT_EQ( LedFlush_Service(&flush, 0, 1), 1 );
+    ASSERT_EQ( writtenMask(4), 0x03u );
+    ASSERT_EQ( LedFlush_Service(&flush, 0, 1), 1 );
+    ASSERT_EQ( writtenMask(4), 0x0Bu );
+}
+
+//TEST_F(LedFlush_Operation, "5. Writes after the deadline are counted as missed")
+TEST_F(LedFlush_Operation, 5LateWritesAreMissed)
+{
+    LedFlush_Stats stats;
+
+    LedFlush_Add(&flush, &bank[0], 5);
+    LedFlush_Add(&flush, &bank[2], 50);
+
+    LedDriver_BankTurnOn(&bank[0], 1);
+    LedDriver_BankTurnOn(&bank[2], 1);
+
+    // Seen at tick 100 but the bus is not free until tick 120
+    ASSERT_EQ( LedFlush_Service(&flush, 100, 0), 0 );
+    ASSERT_EQ( LedFlush_Service(&flush, 120, 8), 2 );
+
+    LedFlush_GetStats(&flush, &stats);
+
+    ASSERT_EQ( stats.missed, 1u );
+    ASSERT_EQ( stats.max_lateness, 15u );
+}
+
+//TEST_F(LedFlush_Operation, "6. Changes undone before the flush are not written")
+TEST_F(LedFlush_Operation, 6UndoneChangesAreCancelled)
+{
+    LedFlush_Stats stats;
+
+    LedFlush_Add(&flush, &bank[0], 10);
+
+    LedDriver_BankTurnOn(&bank[0], 1);
+    LedFlush_Service(&flush, 0, 0);
+    LedDriver_BankTurnOff(&bank[0], 1);
+
+    ASSERT_EQ( LedFlush_Service(&flush, 1, 8), 0 );
+
+    LedFlush_GetStats(&flush, &stats);
+
+    ASSERT_EQ( stats.bursts, 0u );
+    ASSERT_EQ( stats.cancelled, 1u );
+}
+
+//TEST_F(LedFlush_Operation, "7. Detach writes pending changes and restores direct writes")
+TEST_F(LedFlush_Operation, 7DetachRestoresDirectWrites)
+{
+    LedFlush_Add(&flush, &bank[0], 10);
+    LedFlush_Add(&flush, &bank[5], 10);
+
+    LedDriver_BankTurnOn(&bank[0], 1);
+
+    ASSERT_EQ( LedFlush_Detach(&flush, 0), 0 );
+    ASSERT_EQ( registers[0], 0x0001 );
+
+    LedDriver_BankTurnOn(&bank[5], 16);
+
+    ASSERT_EQ( registers[5], 0x8000 );
+}
+
+//TEST_F(LedFlush_Operation, "8. Many banks flush in deadline order")
+TEST_F(LedFlush_Operation, 8ManyBanksFlushInDeadlineOrder)
+{
+    uint32_t deadline[REGISTERS];
+    uint32_t previous = 0;
+    uint32_t seed = 12345;
+
+    // Every other register, so no two banks share a burst
+    for (int i = 0; i < REGISTERS; i += 2)
+    {
+        seed = (seed * 1103515245u) + 12345u;
+        deadline[i] = 1000000000u + ((seed >> 16) % 1000);
+
+        ASSERT_EQ( LedFlush_Add(&flush, &bank[i], deadline[i]), i / 2 );
+
+        LedDriver_BankTurnOn(&bank[i], 1);
+    }
+
+    // Start near the wrap so deadlines cross zero
+    for (int n = 0; n < REGISTERS / 2; n++)
+    {
+        uint32_t before[REGISTERS];
+
+        for (int i = 0; i < REGISTERS; i++)
+        {
+            before[i] = registers[i];
+        }
+
+        ASSERT_EQ( LedFlush_Service(&flush, 0xC0000000u, 1), 1 );
+
+        for (int i = 0; i < REGISTERS; i += 2)
+        {
+            if (before[i] != registers[i])
+            {
+                ASSERT_GE( deadline[i], previous );
+                previous = deadline[i];
+            }
+        }
+    }
+
+    ASSERT_EQ( LedFlush_Service(&flush, 0xC0000000u, 1), 0 );
+}
+
+//TEST_F(LedFlush_Operation, "9. Bad arguments and repeated registers are rejected")
+TEST_F(LedFlush_Operation, 9BadArgumentsAreRejected)
+{
+    LedDriver_Bank unset = {};
+    LedDriver_Bank alias;
+
+    LedDriver_BankInit(&alias, &registers[0], false, false);
+
+    ASSERT_EQ( LedFlush_Init(NULL), -1 );
+    ASSERT_EQ( LedFlush_Add(&flush, NULL, 10), -1 );
+    ASSERT_EQ( LedFlush_Add(&flush, &unset, 10), -1 );
+    ASSERT_EQ( LedFlush_Add(&flush, &bank[0], 10), 0 );
+    ASSERT_EQ( LedFlush_Add(&flush, &bank[0], 10), -1 );
+    ASSERT_EQ( LedFlush_Add(&flush, &alias, 10), -1 );
+    ASSERT_EQ( LedFlush_SetDeadline(&flush, 0, 20), 0 );
+    ASSERT_EQ( LedFlush_SetDeadline(&flush, 1, 20), -1 );
+    ASSERT_EQ( LedFlush_Service(NULL, 0, 1), -1 );
+}
+
+//TEST_F(LedFlush_Operation, "10. A burst leaves out neighbours changed back while queued")
+TEST_F(LedFlush_Operation, 10BurstSkipsUndoneNeighbours)
+{
+    LedFlush_Stats stats;
+
+    // Bank 1 is due last so its neighbours' bursts reach it first
+    LedFlush_Add(&flush, &bank[0], 10);
+    LedFlush_Add(&flush, &bank[1], 100);
+    LedFlush_Add(&flush, &bank[2], 10);
+
+    // Bank 1 is queued, then changed back before the flush
+    LedDriver_BankTurnOn(&bank[1], 1);
+    LedFlush_Service(&flush, 0, 0);
+    LedDriver_BankTurnOff(&bank[1], 1);
+
+    LedDriver_BankTurnOn(&bank[0], 1);
+    LedDriver_BankTurnOn(&bank[2], 1);
+
+    ASSERT_EQ( LedFlush_Service(&flush, 1, 8), 2 );
+    ASSERT_EQ( writtenMask(3), 0x05u );
+
+    LedFlush_GetStats(&flush, &stats);
+
+    ASSERT_EQ( stats.bursts, 2u );
+    ASSERT_EQ( stats.registers, 2u );
+    ASSERT_EQ( stats.merged, 0u );
+    ASSERT_EQ( stats.cancelled, 1u );
+}
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include "LedGroup.h"
+#include "stdint.h"
+#include "RuntimeErrorStub.h"
+#include "string.h"
+
+/***********************************************************************
+ * LED Group Test
+ *
+ * Requirements:
+ * 1. A group switches its LEDs on and off together
+ * 2. A group can span several banks
+ * 3. Groups are compiled through each bank's map
+ * 4. Bad LEDs and banks are refused
+ * 5. Groups can be found by name
+ *
+************************************************************************/
+
+class LedGroup_Operation : public ::testing::Test
+{
+    protected:
+        LedDriver_Bank first;
+        LedDriver_Bank second;
+        uint16_t firstLEDs;
+        uint16_t secondLEDs;
+        LedGroup group;
+
+        virtual void SetUp()
+        {
+            LedDriver_BankInit(&first, &firstLEDs, false, false);
+            LedDriver_BankInit(&second, &secondLEDs, true, true);
+            LedGroup_Init(&group, "power row");
+        }
+
+        virtual void TearDown()
+        {
+            // tear down code
+        }
+};
+
+//TEST_F(LedGroup_Operation, "1. A group switches its LEDs on and off together")
+TEST_F(LedGroup_Operation, 1GroupSwitchesTogether)
+{
+    LedGroup_Add(&group, &first, 1);
+    LedGroup_Add(&group, &first, 3);
+    LedGroup_Add(&group, &first, 16);
+
+    ASSERT_EQ( group.parts, 1 );
+
+    LedDriver_BankTurnOn(&first, 2);
+
+    ASSERT_EQ( LedGroup_TurnOn(&group), 0 );
+    ASSERT_EQ( firstLEDs, 0x8007 );
+
+    ASSERT_EQ( LedGroup_TurnOff(&group), 0 );
+    ASSERT_EQ( firstLEDs, 0x0002 );
+}
+
+//TEST_F(LedGroup_Operation, "2. A group can span several banks")
+TEST_F(LedGroup_Operation, 2GroupSpansBanks)
+{
+    LedGroup_Add(&group, &first, 4);
+    LedGroup_Add(&group, &second, 1);
+    LedGroup_Add(&group, &second, 2);
+
+    ASSERT_EQ( group.parts, 2 );
+
+    LedGroup_TurnOn(&group);
+
+    ASSERT_EQ( firstLEDs, 0x0008 );
+    ASSERT_EQ( secondLEDs, 0x3FFF );
+    ASSERT_TRUE( LedDriver_BankIsOn(&second, 1) );
+    ASSERT_TRUE( LedDriver_BankIsOn(&second, 2) );
+}
+
+//TEST_F(LedGroup_Operation, "3. Groups are compiled through each bank's map")
+TEST_F(LedGroup_Operation, 3GroupsFollowBankMap)
+{
+    LedDriver_Map map;
+    uint8_t physical[16] = { 15, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14 };
+
+    LedDriver_MapInit(&map, physical);
+    LedDriver_BankInitMapped(&first, &firstLEDs, false, &map);
+
+    LedGroup_Add(&group, &first, 1);
+    LedGroup_Add(&group, &first, 2);
+
+    LedGroup_TurnOn(&group);
+
+    ASSERT_EQ( firstLEDs, 0x8001 );
+}
+
+//TEST_F(LedGroup_Operation, "4. Bad LEDs and banks are refused")
+TEST_F(LedGroup_Operation, 4BadLEDsAndBanksAreRefused)
+{
+    LedDriver_Bank banks[LED_GROUP_MAX_BANKS + 1];
+    uint16_t registers[LED_GROUP_MAX_BANKS + 1];
+
+    RuntimeErrorStub_Reset();
+
+    ASSERT_EQ( LedGroup_Add(&group, &first, 17), -1 );
+    ASSERT_EQ( 0, strcmp("LED Group: out-of-bounds LED", RuntimeErrorStub_GetLastError()) );
+    ASSERT_EQ( 17, RuntimeErrorStub_GetLastParameter() );
+
+    ASSERT_EQ( LedGroup_Add(&group, NULL, 1), -1 );
+    ASSERT_EQ( LedGroup_Add(NULL, &first, 1), -1 );
+
+    for (int i = 0; i <= LED_GROUP_MAX_BANKS; i++)
+    {
+        LedDriver_BankInit(&banks[i], &registers[i], false, false);
+    }
+
+    for (int i = 0; i < LED_GROUP_MAX_BANKS; i++)
+    {
+        ASSERT_EQ( LedGroup_Add(&group, &banks[i], 1), 0 );
+    }
+
+    ASSERT_EQ( LedGroup_Add(&group, &banks[LED_GROUP_MAX_BANKS], 1), -1 );
+    ASSERT_EQ( LedGroup_Add(&group, &banks[0], 2), 0 );
+}
+
+//TEST_F(LedGroup_Operation, "5. Groups can be found by name")
+TEST_F(LedGroup_Operation, 5GroupsCanBeFoundByName)
+{
+    LedGroup groups[3];
+
+    LedGroup_Init(&groups[0], "power row");
+    LedGroup_Init(&groups[1], "zone 3");
+    LedGroup_Init(&groups[2], NULL);
+
+    ASSERT_TRUE( &groups[1] == LedGroup_Find(groups, 3, "zone 3") );
+    ASSERT_TRUE( &groups[0] == LedGroup_Find(groups, 3, "power row") );
+    ASSERT_TRUE( NULL == LedGroup_Find(groups, 3, "zone 4") );
+    ASSERT_TRUE( NULL == LedGroup_Find(groups, 3, NULL) );
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#define LED_DRIVER_INLINE
+#include "LedDriver.h"
+#include "LedPool.h"
+#include "stdint.h"
+#include "RuntimeErrorStub.h"
+#include "string.h"
+
+// The inline build must not leave its implementation macros in the includer
+#if defined(TRUE) || defined(FALSE) || defined(MIN_LED) || defined(ALL_LEDS_ON) || defined(LED_DRIVER_LIKELY)
+#error "LedDriverImpl.h macros leaked into the includer"
+#endif
+
+/***********************************************************************
+ * LED Inline Build Test
+ *
+ * Requirements:
+ * 1. The inline API drives a bank exactly like the library
+ * 2. The inline default API drives the default bank
+ * 3. Out-of-bounds LEDs still raise a runtime error
+ * 4. Banks initialised by the library use the same built-in maps
+ *
+************************************************************************/
+
+static uint16_t InlineLEDs;
+
+TEST( LedDriver_Inline, 1BankMatchesLibraryBehaviour )
+{
+    LedDriver_Bank bank;
+
+    InlineLEDs = 0x0000;
+
+    ASSERT_EQ( LedDriver_BankInit(&bank, &InlineLEDs, true, true), 0 );
+    ASSERT_EQ( InlineLEDs, 0xFFFF );
+
+    LedDriver_BankTurnOn(&bank, 1);
+    LedDriver_BankTurnOn(&bank, 16);
+    ASSERT_EQ( InlineLEDs, 0x7FFE );
+
+    ASSERT_TRUE( LedDriver_BankIsOn(&bank, 16) );
+    ASSERT_TRUE( LedDriver_BankIsOff(&bank, 8) );
+
+    LedDriver_BankTurnOnAll(&bank);
+    ASSERT_EQ( InlineLEDs, 0x0000 );
+}
+
+TEST( LedDriver_Inline, 2DefaultApiDrivesDefaultBank )
+{
+    InlineLEDs = 0xFFFF;
+
+    ASSERT_EQ( LedDriver_Init(&InlineLEDs, false, false), 0 );
+    LedDriver_TurnOn(9);
+
+    ASSERT_EQ( InlineLEDs, 0x0100 );
+    ASSERT_TRUE( LedDriver_IsOn(9) );
+}
+
+TEST( LedDriver_Inline, 3OutOfBoundsRaisesRuntimeError )
+{
+    LedDriver_Bank bank;
+
+    RuntimeErrorStub_Reset();
+    ASSERT_EQ( LedDriver_BankInit(&bank, &InlineLEDs, false, false), 0 );
+
+    ASSERT_EQ( LedDriver_BankTurnOn(&bank, 17), -1 );
+    ASSERT_EQ( 0, strcmp("LED Driver: out-of-bounds LED", RuntimeErrorStub_GetLastError()) );
+    ASSERT_EQ( 17, RuntimeErrorStub_GetLastParameter() );
+}
+
+TEST( LedDriver_Inline, 4LibraryBanksShareBuiltInMaps )
+{
+    LedDriver_Bank local;
+    LedDriver_Bank* straight;
+    LedDriver_Bank* reversed;
+
+    LedPool_Init();
+
+    // Acquire initialises the banks inside the library
+    straight = LedPool_Acquire(&InlineLEDs, false, false);
+    ASSERT_NE( straight, nullptr );
+    ASSERT_EQ( straight->map, &LedDriver_StraightMap );
+
+    reversed = LedPool_Acquire(&InlineLEDs, false, true);
+    ASSERT_NE( reversed, nullptr );
+    ASSERT_EQ( reversed->map, &LedDriver_ReversedMap );
+
+    // and a bank initialised here gets the very same map
+    ASSERT_EQ( LedDriver_BankInit(&local, &InlineLEDs, false, false), 0 );
+    ASSERT_EQ( local.map, straight->map );
+
+    ASSERT_EQ( LedDriver_BankUpdate(reversed, 0x0003, 0x0000), 0 );
+    ASSERT_EQ( InlineLEDs, 0xC000 );
+
+    LedPool_Release(straight);
+    LedPool_Release(reversed);
+}
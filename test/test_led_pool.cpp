@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+#include "LedPool.h"
+#include "stdint.h"
+
+#include <thread>
+#include <vector>
+
+/***********************************************************************
+ * LED Pool Test
+ *
+ * Requirements:
+ * 1. An acquired bank is initialised on its register
+ * 2. The pool hands out at most LED_POOL_CAPACITY banks
+ * 3. Released banks can be acquired again
+ * 4. Foreign and double releases are rejected
+ * 5. Released handles can no longer drive the register
+ * 6. Usage statistics track the high-water mark
+ * 7. Banks do not share cache lines
+ * 8. Concurrent acquire and release never hands out a bank twice
+ *
+************************************************************************/
+
+class LedPool_Operation : public ::testing::Test
+{
+    protected:
+        uint16_t registers[LED_POOL_CAPACITY + 1];
+
+        virtual void SetUp()
+        {
+            LedPool_Init();
+
+            for (int i = 0; i <= LED_POOL_CAPACITY; i++)
+            {
+                registers[i] = 0xFFFF;
+            }
+        }
+
+        virtual void TearDown()
+        {
+            // tear down code
+        }
+};
+
+//TEST_F(LedPool_Operation, "1. An acquired bank is initialised on its register")
+TEST_F(LedPool_Operation, 1AcquiredBankIsInitialised)
+{
+    LedDriver_Bank* bank = LedPool_Acquire(&registers[0], false, false);
+
+    ASSERT_TRUE( NULL != bank );
+    ASSERT_EQ( registers[0], 0x0000 );
+
+    LedDriver_BankTurnOn(bank, 3);
+
+    ASSERT_EQ( registers[0], 0x0004 );
+}
+
+//TEST_F(LedPool_Operation, "1. A NULL register is refused")
+TEST_F(LedPool_Operation, 1NullRegisterIsRefused)
+{
+    LedPool_Stats stats;
+
+    ASSERT_TRUE( NULL == LedPool_Acquire(NULL, false, false) );
+
+    LedPool_GetStats(&stats);
+    ASSERT_EQ( stats.in_use, 0u );
+}
+
+//TEST_F(LedPool_Operation, "2. The pool hands out at most LED_POOL_CAPACITY banks")
+TEST_F(LedPool_Operation, 2PoolIsBounded)
+{
+    for (int i = 0; i < LED_POOL_CAPACITY; i++)
+    {
+        ASSERT_TRUE( NULL != LedPool_Acquire(&registers[i], false, false) );
+    }
+
+    ASSERT_TRUE( NULL == LedPool_Acquire(&registers[LED_POOL_CAPACITY], false, false) );
+    ASSERT_EQ( registers[LED_POOL_CAPACITY], 0xFFFF );
+}
+
+//TEST_F(LedPool_Operation, "3. Released banks can be acquired again")
+TEST_F(LedPool_Operation, 3ReleasedBanksCanBeReacquired)
+{
+    LedDriver_Bank* banks[LED_POOL_CAPACITY];
+
+    for (int i = 0; i < LED_POOL_CAPACITY; i++)
+    {
+        banks[i] = LedPool_Acquire(&registers[i], false, false);
+    }
+
+    ASSERT_EQ( LedPool_Release(banks[5]), 0 );
+    ASSERT_TRUE( banks[5] == LedPool_Acquire(&registers[LED_POOL_CAPACITY], true, false) );
+    ASSERT_EQ( registers[LED_POOL_CAPACITY], 0xFFFF );
+}
+
+//TEST_F(LedPool_Operation, "4. Foreign and double releases are rejected")
+TEST_F(LedPool_Operation, 4ForeignAndDoubleReleasesAreRejected)
+{
+    LedDriver_Bank local;
+    LedDriver_Bank* bank = LedPool_Acquire(&registers[0], false, false);
+
+    ASSERT_EQ( LedPool_Release(&local), -1 );
+    ASSERT_EQ( LedPool_Release(NULL), -1 );
+    ASSERT_EQ( LedPool_Release((LedDriver_Bank*)((char*)bank + 1)), -1 );
+    ASSERT_EQ( LedPool_Release(bank), 0 );
+    ASSERT_EQ( LedPool_Release(bank), -1 );
+}
+
+//TEST_F(LedPool_Operation, "5. Released handles can no longer drive the register")
+TEST_F(LedPool_Operation, 5ReleasedHandlesAreInert)
+{
+    LedDriver_Bank* bank = LedPool_Acquire(&registers[0], false, false);
+
+    LedPool_Release(bank);
+
+    ASSERT_EQ( LedDriver_BankTurnOn(bank, 1), -1 );
+    ASSERT_EQ( registers[0], 0x0000 );
+}
+
+//TEST_F(LedPool_Operation, "6. Usage statistics track the high-water mark")
+TEST_F(LedPool_Operation, 6StatisticsTrackHighWater)
+{
+    LedPool_Stats stats;
+    LedDriver_Bank* first = LedPool_Acquire(&registers[0], false, false);
+    LedDriver_Bank* second = LedPool_Acquire(&registers[1], false, false);
+
+    LedPool_Release(first);
+    LedPool_Release(second);
+    LedPool_Acquire(&registers[2], false, false);
+
+    LedPool_GetStats(&stats);
+
+    ASSERT_EQ( stats.capacity, (uint32_t)LED_POOL_CAPACITY );
+    ASSERT_EQ( stats.in_use, 1u );
+    ASSERT_EQ( stats.high_water, 2u );
+    ASSERT_EQ( stats.exhausted, 0u );
+}
+
+//TEST_F(LedPool_Operation, "6. Exhaustion is counted")
+TEST_F(LedPool_Operation, 6ExhaustionIsCounted)
+{
+    LedPool_Stats stats;
+
+    for (int i = 0; i <= LED_POOL_CAPACITY; i++)
+    {
+        LedPool_Acquire(&registers[i], false, false);
+    }
+
+    LedPool_GetStats(&stats);
+
+    ASSERT_EQ( stats.high_water, (uint32_t)LED_POOL_CAPACITY );
+    ASSERT_EQ( stats.exhausted, 1u );
+}
+
+//TEST_F(LedPool_Operation, "7. Banks do not share cache lines")
+TEST_F(LedPool_Operation, 7BanksDoNotShareCacheLines)
+{
+    LedDriver_Bank* first = LedPool_Acquire(&registers[0], false, false);
+    LedDriver_Bank* second = LedPool_Acquire(&registers[1], false, false);
+
+    ASSERT_EQ( (uintptr_t)first % LED_POOL_CACHE_LINE, 0u );
+    ASSERT_EQ( (uintptr_t)second % LED_POOL_CACHE_LINE, 0u );
+    ASSERT_NE( (uintptr_t)first / LED_POOL_CACHE_LINE, (uintptr_t)second / LED_POOL_CACHE_LINE );
+}
+
+//TEST_F(LedPool_Operation, "8. Concurrent acquire and release never hands out a bank twice")
+TEST_F(LedPool_Operation, 8ConcurrentAcquireRelease)
+{
+    const int threads = 4;
+    const int rounds = 20000;
+    std::vector<std::thread> workers;
+    std::vector<int> failures(threads, 0);
+    LedPool_Stats stats;
+
+    for (int t = 0; t < threads; t++)
+    {
+        workers.push_back(std::thread([this, t, rounds, &failures]()
+        {
+            for (int i = 0; i < rounds; i++)
+            {
+                LedDriver_Bank* bank = LedPool_Acquire(&registers[t], false, false);
+
+                if (NULL == bank)
+                {
+                    continue;
+                }
+
+                // A bank handed out twice would see another thread's register here
+                if ((bank->address != &registers[t]) || (0 != LedPool_Release(bank)))
+                {
+                    failures[t]++;
+                }
+            }
+        }));
+    }
+
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+
+    LedPool_GetStats(&stats);
+
+    for (int t = 0; t < threads; t++)
+    {
+        ASSERT_EQ( failures[t], 0 );
+    }
+
+    ASSERT_EQ( stats.in_use, 0u );
+    ASSERT_LE( stats.high_water, (uint32_t)threads );
+}
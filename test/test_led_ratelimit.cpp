@@ -0,0 +1,267 @@
+#include <gtest/gtest.h>
+#include "LedRateLimit.h"
+#include "stdint.h"
+
+/***********************************************************************
+ * LED Rate Limit Test
+ *
+ * Requirements:
+ * 1. The first change is written straight away
+ * 2. Changes inside the window are coalesced into one write
+ * 3. A pending change is written once the window has passed
+ * 4. Critical LEDs bypass the limit at the next Service
+ * 5. Flush writes pending state regardless of the limit
+ * 6. Detaching restores direct writes
+ * 7. Tick counters may wrap
+ * 8. Superseded counts every driver write that never reached the register
+ * 9. A bank cannot be attached twice, to the same limiter or another
+ *
+************************************************************************/
+
+class LedRateLimit_Operation : public ::testing::Test
+{
+    protected:
+        LedDriver_Bank bank;
+        LedRateLimit limit;
+        uint16_t LEDs;
+
+        virtual void SetUp()
+        {
+            LedDriver_BankInit(&bank, &LEDs, false, false);
+            ASSERT_EQ( LedRateLimit_Init(&limit, &bank, 100, 1000), 0 );
+        }
+
+        virtual void TearDown()
+        {
+            // tear down code
+        }
+};
+
+//TEST_F(LedRateLimit_Operation, "1. The first change is written straight away")
+TEST_F(LedRateLimit_Operation, 1FirstChangeIsWritten)
+{
+    LedDriver_BankTurnOn(&bank, 1);
+
+    ASSERT_EQ( LEDs, 0x0000 );
+    ASSERT_EQ( LedRateLimit_Service(&limit, 1000), 1 );
+    ASSERT_EQ( LEDs, 0x0001 );
+}
+
+//TEST_F(LedRateLimit_Operation, "2. Changes inside the window are coalesced into one write")
+TEST_F(LedRateLimit_Operation, 2ChangesInWindowAreCoalesced)
+{
+    LedRateLimit_Stats stats;
+
+    LedDriver_BankTurnOn(&bank, 1);
+    LedRateLimit_Service(&limit, 1000);
+
+    for (int led = 2; led <= 6; led++)
+    {
+        LedDriver_BankTurnOn(&bank, led);
+        ASSERT_EQ( LedRateLimit_Service(&limit, 1000 + led), 0 );
+    }
+
+    ASSERT_EQ( LEDs, 0x0001 );
+    ASSERT_EQ( LedRateLimit_Service(&limit, 1100), 1 );
+    ASSERT_EQ( LEDs, 0x003F );
+
+    LedRateLimit_GetStats(&limit, &stats);
+
+    ASSERT_EQ( stats.writes, 2u );
+    ASSERT_EQ( stats.superseded, 4u );
+}
+
+//TEST_F(LedRateLimit_Operation, "2. Changes undone inside the window are never written")
+TEST_F(LedRateLimit_Operation, 2UndoneChangesAreNeverWritten)
+{
+    LedRateLimit_Stats stats;
+
+    LedRateLimit_Service(&limit, 1000);
+    LedDriver_BankTurnOn(&bank, 1);
+    LedRateLimit_Service(&limit, 1000);
+
+    LedDriver_BankTurnOn(&bank, 2);
+    LedRateLimit_Service(&limit, 1010);
+    LedDriver_BankTurnOff(&bank, 2);
+    LedRateLimit_Service(&limit, 1020);
+
+    ASSERT_EQ( LedRateLimit_Service(&limit, 1200), 0 );
+
+    LedRateLimit_GetStats(&limit, &stats);
+
+    ASSERT_EQ( stats.writes, 1u );
+    ASSERT_EQ( stats.superseded, 2u );
+}
+
+//TEST_F(LedRateLimit_Operation, "3. A pending change is written once the window has passed")
+TEST_F(LedRateLimit_Operation, 3PendingChangeIsWrittenAfterWindow)
+{
+    LedDriver_BankTurnOn(&bank, 1);
+    LedRateLimit_Service(&limit, 1000);
+
+    LedDriver_BankTurnOn(&bank, 2);
+    ASSERT_EQ( LedRateLimit_Service(&limit, 1050), 0 );
+    ASSERT_EQ( LedRateLimit_Service(&limit, 1099), 0 );
+    ASSERT_EQ( LedRateLimit_Service(&limit, 1100), 1 );
+    ASSERT_EQ( LEDs, 0x0003 );
+}
+
+//TEST_F(LedRateLimit_Operation, "4. Critical LEDs bypass the limit at the next Service")
+TEST_F(LedRateLimit_Operation, 4CriticalLEDsBypassLimit)
+{
+    LedRateLimit_Stats stats;
+
+    LedRateLimit_SetCritical(&limit, 0x8000);
+
+    LedDriver_BankTurnOn(&bank, 1);
+    LedRateLimit_Service(&limit, 1000);
+
+    LedDriver_BankTurnOn(&bank, 2);
+    LedRateLimit_Service(&limit, 1001);
+    LedDriver_BankTurnOn(&bank, 16);
+
+    // Not before Service is called
+    ASSERT_EQ( LEDs, 0x0001 );
+
+    ASSERT_EQ( LedRateLimit_Service(&limit, 1002), 1 );
+    ASSERT_EQ( LEDs, 0x8003 );
+
+    LedRateLimit_GetStats(&limit, &stats);
+
+    ASSERT_EQ( stats.forced, 1u );
+
+    // Once the interval is up the write is not forced
+    LedDriver_BankTurnOff(&bank, 16);
+    ASSERT_EQ( LedRateLimit_Service(&limit, 1102), 1 );
+
+    LedRateLimit_GetStats(&limit, &stats);
+
+    ASSERT_EQ( stats.forced, 1u );
+}
+
+//TEST_F(LedRateLimit_Operation, "5. Flush writes pending state regardless of the limit")
+TEST_F(LedRateLimit_Operation, 5FlushWritesPendingState)
+{
+    LedRateLimit_Stats stats;
+
+    LedDriver_BankTurnOn(&bank, 1);
+    LedRateLimit_Service(&limit, 1000);
+    LedDriver_BankTurnOn(&bank, 2);
+    LedRateLimit_Service(&limit, 1001);
+
+    ASSERT_EQ( LedRateLimit_Flush(&limit, 1002), 1 );
+    ASSERT_EQ( LEDs, 0x0003 );
+    ASSERT_EQ( LedRateLimit_Flush(&limit, 1003), 0 );
+
+    LedRateLimit_GetStats(&limit, &stats);
+
+    ASSERT_EQ( stats.writes, 2u );
+    ASSERT_EQ( stats.forced, 1u );
+    ASSERT_EQ( stats.superseded, 0u );
+}
+
+//TEST_F(LedRateLimit_Operation, "6. Detaching restores direct writes")
+TEST_F(LedRateLimit_Operation, 6DetachRestoresDirectWrites)
+{
+    LedDriver_BankTurnOn(&bank, 1);
+    LedRateLimit_Service(&limit, 1000);
+    LedDriver_BankTurnOn(&bank, 2);
+
+    ASSERT_EQ( LedRateLimit_Detach(&limit), 0 );
+    ASSERT_EQ( LEDs, 0x0003 );
+
+    LedDriver_BankTurnOn(&bank, 3);
+    ASSERT_EQ( LEDs, 0x0007 );
+
+    ASSERT_EQ( LedRateLimit_Service(&limit, 2000), -1 );
+    ASSERT_EQ( LedRateLimit_Detach(&limit), -1 );
+}
+
+//TEST_F(LedRateLimit_Operation, "7. Tick counters may wrap")
+TEST_F(LedRateLimit_Operation, 7TickCountersMayWrap)
+{
+    LedRateLimit_Detach(&limit);
+    ASSERT_EQ( LedRateLimit_Init(&limit, &bank, 100, 0xFFFFFFF0u), 0 );
+
+    LedDriver_BankTurnOn(&bank, 1);
+    ASSERT_EQ( LedRateLimit_Service(&limit, 0xFFFFFFF0u), 1 );
+    ASSERT_EQ( LEDs, 0x0001 );
+
+    LedDriver_BankTurnOn(&bank, 2);
+    ASSERT_EQ( LedRateLimit_Service(&limit, 0x00000010u), 0 );
+    ASSERT_EQ( LEDs, 0x0001 );
+    ASSERT_EQ( LedRateLimit_Service(&limit, 0x00000054u), 1 );
+    ASSERT_EQ( LEDs, 0x0003 );
+}
+
+//TEST_F(LedRateLimit_Operation, "8. Superseded counts every driver write that never reached the register")
+TEST_F(LedRateLimit_Operation, 8SupersededCountsDriverWrites)
+{
+    LedRateLimit_Stats stats;
+
+    // Eight driver writes between two Service calls, one register write
+    for (int led = 1; led <= 8; led++)
+    {
+        LedDriver_BankTurnOn(&bank, led);
+    }
+
+    ASSERT_EQ( LedRateLimit_Service(&limit, 1000), 1 );
+    ASSERT_EQ( LEDs, 0x00FF );
+
+    LedRateLimit_GetStats(&limit, &stats);
+
+    ASSERT_EQ( stats.writes, 1u );
+    ASSERT_EQ( stats.superseded, 7u );
+
+    // Writes that change nothing are saved too
+    LedDriver_BankTurnOn(&bank, 9);
+    LedRateLimit_Service(&limit, 1010);
+    LedDriver_BankTurnOn(&bank, 9);
+    LedDriver_BankTurnOn(&bank, 10);
+    LedRateLimit_Service(&limit, 1020);
+    ASSERT_EQ( LedRateLimit_Service(&limit, 1100), 1 );
+
+    LedRateLimit_GetStats(&limit, &stats);
+
+    ASSERT_EQ( stats.writes, 2u );
+    ASSERT_EQ( stats.superseded, 9u );
+}
+
+//TEST_F(LedRateLimit_Operation, "9. A bank cannot be attached twice")
+TEST_F(LedRateLimit_Operation, 9AttachedBankIsRejected)
+{
+    ASSERT_EQ( LedRateLimit_Init(&limit, &bank, 100, 1000), -1 );
+
+    // Still attached to the register it was attached to first
+    LedDriver_BankTurnOn(&bank, 1);
+    ASSERT_EQ( LedRateLimit_Service(&limit, 1000), 1 );
+    ASSERT_EQ( LEDs, 0x0001 );
+
+    LedRateLimit_Detach(&limit);
+    ASSERT_EQ( LedRateLimit_Init(&limit, &bank, 100, 1000), 0 );
+
+    LedDriver_BankTurnOn(&bank, 2);
+    ASSERT_EQ( LedRateLimit_Service(&limit, 1000), 1 );
+    ASSERT_EQ( LEDs, 0x0003 );
+
+    // Nor to a second limiter, which would take the first one's staging
+    // word for the register
+    LedRateLimit other;
+
+    ASSERT_EQ( LedRateLimit_Init(&other, &bank, 100, 1000), -1 );
+
+    LedDriver_BankTurnOn(&bank, 3);
+    ASSERT_EQ( LedRateLimit_Service(&limit, 1100), 1 );
+    ASSERT_EQ( LEDs, 0x0007 );
+}
+
+TEST( LedRateLimit_Init, NeedsInitialisedBank )
+{
+    LedDriver_Bank bank;
+    LedRateLimit limit;
+
+    LedDriver_BankInit(&bank, NULL, false, false);
+
+    ASSERT_EQ( LedRateLimit_Init(&limit, &bank, 100, 0), -1 );
+    ASSERT_EQ( LedRateLimit_Init(&limit, NULL, 100, 0), -1 );
+}
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include "LedDriver.h"
+#include "stdint.h"
+#include "string.h"
+
+#include <atomic>
+#include <thread>
+
+/***********************************************************************
+ * LED Reader Test
+ *
+ * Requirements:
+ * 1. A bank can be copied as one snapshot
+ * 2. Ordinary updates leave the sequence alone
+ * 3. Readers never see a half re-initialised bank
+ * 4. A bank whose Init failed reads as all off
+ * 5. Redirecting a bank goes through the sequence
+ *
+************************************************************************/
+
+class LedReader_Operation : public ::testing::Test
+{
+    protected:
+        LedDriver_Bank bank;
+        uint16_t LEDs;
+
+        virtual void SetUp()
+        {
+            bank.sequence = 0;
+            LedDriver_BankInit(&bank, &LEDs, true, true);
+        }
+
+        virtual void TearDown()
+        {
+            // tear down code
+        }
+};
+
+//TEST_F(LedReader_Operation, "1. A bank can be copied as one snapshot")
+TEST_F(LedReader_Operation, 1BankIsCopiedAsSnapshot)
+{
+    LedDriver_Bank copy;
+
+    LedDriver_BankTurnOn(&bank, 1);
+
+    ASSERT_EQ( LedDriver_BankRead(&bank, &copy), 0 );
+    ASSERT_EQ( copy.address, &LEDs );
+    ASSERT_EQ( copy.map, bank.map );
+    ASSERT_EQ( copy.status, 0x7FFF );
+    ASSERT_TRUE( copy.inverted_output );
+    ASSERT_TRUE( copy.inverted_input );
+    ASSERT_TRUE( LedDriver_BankIsOn(&copy, 1) );
+
+    ASSERT_EQ( LedDriver_BankRead(NULL, &copy), -1 );
+    ASSERT_EQ( LedDriver_BankRead(&bank, NULL), -1 );
+}
+
+//TEST_F(LedReader_Operation, "2. Ordinary updates leave the sequence alone")
+TEST_F(LedReader_Operation, 2UpdatesLeaveSequenceAlone)
+{
+    uint32_t sequence = bank.sequence;
+
+    ASSERT_EQ( sequence % 2, 0u );
+
+    LedDriver_BankTurnOn(&bank, 3);
+    LedDriver_BankUpdate(&bank, 0x00F0, 0x0001);
+    LedDriver_BankTurnOffAll(&bank);
+    ASSERT_EQ( bank.sequence, sequence );
+
+    LedDriver_BankInit(&bank, &LEDs, false, false);
+    ASSERT_EQ( bank.sequence, sequence + 2 );
+
+    ASSERT_EQ( LedDriver_BankInit(&bank, NULL, false, false), -1 );
+    ASSERT_EQ( bank.sequence % 2, 0u );
+}
+
+//TEST_F(LedReader_Operation, "3. Readers never see a half re-initialised bank")
+TEST_F(LedReader_Operation, 3ReadersNeverSeeTornState)
+{
+    std::atomic<bool> stop(false);
+    uint32_t torn = 0;
+
+    // Every state the writer sets has every LED off, whatever the polarity
+    std::thread writer([&]()
+    {
+        for (int i = 0; i < 200000; i++)
+        {
+            LedDriver_BankInit(&bank, &LEDs, (0 != (i & 1)), (0 != (i & 2)));
+        }
+
+        stop.store(true);
+    });
+
+    while (false == stop.load())
+    {
+        LedDriver_Bank copy;
+
+        if (LedDriver_BankIsOn(&bank, 1) || LedDriver_BankIsOn(&bank, 16))
+        {
+            torn++;
+        }
+
+        LedDriver_BankRead(&bank, &copy);
+
+        if (copy.status != (copy.inverted_output ? 0xFFFF : 0x0000))
+        {
+            torn++;
+        }
+    }
+
+    writer.join();
+
+    ASSERT_EQ( torn, 0u );
+}
+
+//TEST_F(LedReader_Operation, "4. A bank whose Init failed reads as all off")
+TEST_F(LedReader_Operation, 4FailedInitReadsAllOff)
+{
+    LedDriver_Bank garbage;
+
+    // The map pointer is whatever the storage held
+    memset(&garbage, 0xA5, sizeof(garbage));
+    garbage.sequence = 0;
+
+    ASSERT_EQ( LedDriver_BankInit(&garbage, NULL, false, false), -1 );
+
+    for (int16_t led = 1; led <= 16; led++)
+    {
+        ASSERT_FALSE( LedDriver_BankIsOn(&garbage, led) );
+    }
+}
+
+//TEST_F(LedReader_Operation, "5. Redirecting a bank goes through the sequence")
+TEST_F(LedReader_Operation, 5RedirectGoesThroughSequence)
+{
+    uint16_t other;
+    uint32_t sequence = bank.sequence;
+
+    ASSERT_EQ( LedDriver_BankRedirect(&bank, &other), 0 );
+    ASSERT_EQ( bank.address, &other );
+    ASSERT_EQ( bank.sequence, sequence + 2 );
+
+    ASSERT_EQ( LedDriver_BankRedirect(&bank, NULL), 0 );
+    ASSERT_FALSE( LedDriver_BankIsOn(&bank, 1) );
+    ASSERT_EQ( LedDriver_BankTurnOn(&bank, 1), -1 );
+
+    ASSERT_EQ( LedDriver_BankRedirect(NULL, &other), -1 );
+}
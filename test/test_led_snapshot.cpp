@@ -0,0 +1,215 @@
+#include <gtest/gtest.h>
+#include "LedSnapshot.h"
+#include "stdint.h"
+#include "stdio.h"
+#include <string>
+
+/***********************************************************************
+ * LED Snapshot Test
+ *
+ * Requirements:
+ * 1. A new checkpoint has nothing to restore
+ * 2. Restoring brings back the saved state with one register write
+ * 3. A snapshot survives closing and reopening the file
+ * 4. Polarity and custom maps are restored, mismatched maps refused
+ * 5. A torn or corrupt save falls back to the previous snapshot
+ * 6. A checkpoint sized for another number of banks is not restored
+ * 7. The default bank can be saved and adopted
+ *
+************************************************************************/
+
+#define BANKS 3
+
+class LedSnapshot_Operation : public ::testing::Test
+{
+    protected:
+        std::string path;
+        LedSnapshot snapshot;
+        LedDriver_Bank bank[BANKS];
+        LedDriver_Bank* banks[BANKS];
+        uint16_t LEDs[BANKS];
+
+        virtual void SetUp()
+        {
+            path = testing::TempDir() + "led_snapshot_test.bin";
+            remove(path.c_str());
+
+            LedDriver_BankInit(&bank[0], &LEDs[0], false, false);
+            LedDriver_BankInit(&bank[1], &LEDs[1], true, false);
+            LedDriver_BankInit(&bank[2], &LEDs[2], false, true);
+
+            for (int i = 0; i < BANKS; i++)
+            {
+                banks[i] = &bank[i];
+            }
+
+            ASSERT_EQ( LedSnapshot_Open(&snapshot, path.c_str(), BANKS), 0 );
+        }
+
+        virtual void TearDown()
+        {
+            LedSnapshot_Close(&snapshot);
+            remove(path.c_str());
+        }
+};
+
+//TEST_F(LedSnapshot_Operation, "1. A new checkpoint has nothing to restore")
+TEST_F(LedSnapshot_Operation, 1NewCheckpointHasNothingToRestore)
+{
+    LedDriver_Bank restored;
+    uint16_t hardware = 0x1234;
+
+    ASSERT_EQ( LedSnapshot_Restore(&snapshot, 0, &restored, &hardware, NULL), -1 );
+    ASSERT_EQ( hardware, 0x1234 );
+}
+
+//TEST_F(LedSnapshot_Operation, "2. Restoring brings back the saved state with one register write")
+TEST_F(LedSnapshot_Operation, 2RestoreBringsBackSavedState)
+{
+    LedDriver_Bank restored;
+    uint16_t hardware = 0x5A5A;
+
+    LedDriver_BankTurnOn(&bank[0], 3);
+    LedDriver_BankTurnOn(&bank[0], 9);
+    ASSERT_EQ( LedSnapshot_Save(&snapshot, banks, BANKS), 0 );
+
+    ASSERT_EQ( LedSnapshot_Restore(&snapshot, 0, &restored, &hardware, NULL), 0 );
+    ASSERT_EQ( hardware, 0x0104 );
+    ASSERT_TRUE( LedDriver_BankIsOn(&restored, 9) );
+
+    LedDriver_BankTurnOn(&restored, 1);
+    ASSERT_EQ( hardware, 0x0105 );
+}
+
+//TEST_F(LedSnapshot_Operation, "3. A snapshot survives closing and reopening the file")
+TEST_F(LedSnapshot_Operation, 3SnapshotSurvivesReopen)
+{
+    LedDriver_Bank restored;
+    uint16_t hardware;
+
+    LedDriver_BankTurnOn(&bank[0], 1);
+    LedSnapshot_Save(&snapshot, banks, BANKS);
+    LedDriver_BankTurnOn(&bank[0], 2);
+    LedSnapshot_Save(&snapshot, banks, BANKS);
+    ASSERT_EQ( LedSnapshot_Sync(&snapshot), 0 );
+    LedSnapshot_Close(&snapshot);
+
+    ASSERT_EQ( LedSnapshot_Open(&snapshot, path.c_str(), BANKS), 1 );
+    ASSERT_EQ( LedSnapshot_Restore(&snapshot, 0, &restored, &hardware, NULL), 0 );
+    ASSERT_EQ( hardware, 0x0003 );
+}
+
+//TEST_F(LedSnapshot_Operation, "4. Polarity and custom maps are restored, mismatched maps refused")
+TEST_F(LedSnapshot_Operation, 4PolarityAndMapsAreRestored)
+{
+    const uint8_t physical[16] = { 4, 5, 6, 7, 0, 1, 2, 3, 12, 13, 14, 15, 8, 9, 10, 11 };
+    LedDriver_Map map;
+    LedDriver_Map other;
+    LedDriver_Bank restored;
+    uint16_t hardware;
+
+    LedDriver_MapInit(&map, physical);
+    LedDriver_MapInit(&other, physical);
+    other.bits[0] = map.bits[1];
+    other.bits[1] = map.bits[0];
+    LedDriver_BankInitMapped(&bank[2], &LEDs[2], false, &map);
+
+    LedDriver_BankTurnOn(&bank[1], 1);
+    LedDriver_BankTurnOn(&bank[2], 1);
+    LedSnapshot_Save(&snapshot, banks, BANKS);
+
+    ASSERT_EQ( LedSnapshot_Restore(&snapshot, 1, &restored, &hardware, NULL), 0 );
+    ASSERT_EQ( hardware, 0xFFFE );
+    ASSERT_TRUE( restored.inverted_output );
+
+    LedDriver_BankTurnOffAll(&restored);
+    ASSERT_EQ( hardware, 0xFFFF );
+
+    ASSERT_EQ( LedSnapshot_Restore(&snapshot, 2, &restored, &hardware, NULL), -1 );
+    ASSERT_EQ( LedSnapshot_Restore(&snapshot, 2, &restored, &hardware, &other), -1 );
+    ASSERT_EQ( LedSnapshot_Restore(&snapshot, 2, &restored, &hardware, &map), 0 );
+    ASSERT_EQ( hardware, 0x0010 );
+    ASSERT_EQ( LedSnapshot_Restore(&snapshot, 0, &restored, &hardware, &map), -1 );
+}
+
+//TEST_F(LedSnapshot_Operation, "4. Reversed input is restored")
+TEST_F(LedSnapshot_Operation, 4ReversedInputIsRestored)
+{
+    LedDriver_Bank restored;
+    uint16_t hardware;
+
+    LedDriver_BankTurnOn(&bank[2], 1);
+    LedSnapshot_Save(&snapshot, banks, BANKS);
+
+    ASSERT_EQ( LedSnapshot_Restore(&snapshot, 2, &restored, &hardware, NULL), 0 );
+    ASSERT_EQ( hardware, 0x8000 );
+    ASSERT_TRUE( restored.inverted_input );
+
+    LedDriver_BankTurnOn(&restored, 16);
+    ASSERT_EQ( hardware, 0x8001 );
+}
+
+//TEST_F(LedSnapshot_Operation, "5. A torn or corrupt save falls back to the previous snapshot")
+TEST_F(LedSnapshot_Operation, 5CorruptSaveFallsBack)
+{
+    LedDriver_Bank restored;
+    uint16_t hardware;
+    FILE* file;
+    long size;
+
+    LedDriver_BankTurnOn(&bank[0], 1);
+    LedSnapshot_Save(&snapshot, banks, BANKS);
+    LedDriver_BankTurnOn(&bank[0], 2);
+    LedSnapshot_Save(&snapshot, banks, BANKS);
+    LedSnapshot_Close(&snapshot);
+
+    // The second save went to the second half of the file
+    file = fopen(path.c_str(), "r+b");
+    ASSERT_NE( file, nullptr );
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    fseek(file, (size / 2) + 30, SEEK_SET);
+    fputc(0x77, file);
+    fclose(file);
+
+    ASSERT_EQ( LedSnapshot_Open(&snapshot, path.c_str(), BANKS), 1 );
+    ASSERT_EQ( LedSnapshot_Restore(&snapshot, 0, &restored, &hardware, NULL), 0 );
+    ASSERT_EQ( hardware, 0x0001 );
+}
+
+//TEST_F(LedSnapshot_Operation, "6. A checkpoint sized for another number of banks is not restored")
+TEST_F(LedSnapshot_Operation, 6OtherBankCountIsNotRestored)
+{
+    LedSnapshot_Save(&snapshot, banks, BANKS);
+    ASSERT_EQ( LedSnapshot_Save(&snapshot, banks, BANKS - 1), -1 );
+    LedSnapshot_Close(&snapshot);
+
+    ASSERT_EQ( LedSnapshot_Open(&snapshot, path.c_str(), BANKS + 1), 0 );
+}
+
+//TEST_F(LedSnapshot_Operation, "7. The default bank can be saved and adopted")
+TEST_F(LedSnapshot_Operation, 7DefaultBankCanBeAdopted)
+{
+    LedDriver_Bank* defaultBank[1] = { LedDriver_GetDefaultBank() };
+    LedSnapshot single;
+    uint16_t hardware;
+    std::string singlePath = path + ".default";
+
+    LedDriver_Init(&LEDs[0], false, false);
+    LedDriver_TurnOn(5);
+
+    ASSERT_EQ( LedSnapshot_Open(&single, singlePath.c_str(), 1), 0 );
+    ASSERT_EQ( LedSnapshot_Save(&single, defaultBank, 1), 0 );
+
+    LedDriver_Init(&LEDs[0], false, false);
+    ASSERT_EQ( LedSnapshot_Restore(&single, 0, LedDriver_GetDefaultBank(), &hardware, NULL), 0 );
+    ASSERT_EQ( hardware, 0x0010 );
+    ASSERT_TRUE( LedDriver_IsOn(5) );
+
+    ASSERT_EQ( LedDriver_Adopt(&hardware, false, false, 0x0003), 0 );
+    ASSERT_EQ( hardware, 0x0003 );
+    ASSERT_TRUE( LedDriver_IsOn(2) );
+
+    LedSnapshot_Close(&single);
+    remove(singlePath.c_str());
+}
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include "LedStore.h"
+#include "stdint.h"
+#include "stdlib.h"
+
+/***********************************************************************
+ * LED Store Test
+ *
+ * Requirements:
+ * 1. Every LED starts off with zeroed metadata
+ * 2. LEDs can be switched singly and by range across word boundaries
+ * 3. Switching records the change time of the LEDs that changed
+ * 4. Lit and faulted LEDs can be counted and listed in a range
+ * 5. Metadata columns can be queried by range
+ * 6. Bad indices, ranges and storage are refused
+ *
+************************************************************************/
+
+#define LEDS 1000
+
+class LedStore_Operation : public ::testing::Test
+{
+    protected:
+        LedStore store;
+        void* memory;
+
+        virtual void SetUp()
+        {
+            memory = aligned_alloc(64, (LedStore_Size(LEDS) + 63) & ~(size_t)63);
+            ASSERT_EQ( LedStore_Init(&store, memory, LedStore_Size(LEDS), LEDS), 0 );
+        }
+
+        virtual void TearDown()
+        {
+            free(memory);
+        }
+};
+
+//TEST_F(LedStore_Operation, "1. Every LED starts off with zeroed metadata")
+TEST_F(LedStore_Operation, 1LEDsStartOff)
+{
+    ASSERT_EQ( LedStore_CountOn(&store, 0, LEDS), 0u );
+    ASSERT_EQ( LedStore_CountOwnedBy(&store, 0, LEDS, 0), (uint32_t)LEDS );
+    ASSERT_EQ( LedStore_CountBrightnessAtLeast(&store, 0, LEDS, 1), 0u );
+    ASSERT_FALSE( LedStore_IsFaulted(&store, LEDS - 1) );
+}
+
+//TEST_F(LedStore_Operation, "2. LEDs can be switched singly and by range across word boundaries")
+TEST_F(LedStore_Operation, 2LEDsSwitchSinglyAndByRange)
+{
+    ASSERT_EQ( LedStore_Set(&store, 999, true, 0), 0 );
+    ASSERT_TRUE( LedStore_IsOn(&store, 999) );
+
+    ASSERT_EQ( LedStore_SetRange(&store, 60, 200, true, 0), 0 );
+    ASSERT_FALSE( LedStore_IsOn(&store, 59) );
+    ASSERT_TRUE( LedStore_IsOn(&store, 60) );
+    ASSERT_TRUE( LedStore_IsOn(&store, 259) );
+    ASSERT_FALSE( LedStore_IsOn(&store, 260) );
+
+    ASSERT_EQ( LedStore_SetRange(&store, 100, 28, false, 0), 0 );
+
+    ASSERT_EQ( LedStore_CountOn(&store, 0, LEDS), 173u );
+    ASSERT_EQ( LedStore_CountOn(&store, 63, 2), 2u );
+    ASSERT_EQ( LedStore_CountOn(&store, 90, 20), 10u );
+    ASSERT_EQ( LedStore_CountOn(&store, 990, 100), 1u );
+}
+
+//TEST_F(LedStore_Operation, "3. Switching records the change time of the LEDs that changed")
+TEST_F(LedStore_Operation, 3ChangeTimesAreRecorded)
+{
+    LedStore_SetRange(&store, 0, 100, true, 10);
+    LedStore_SetRange(&store, 50, 100, true, 20);
+    LedStore_Set(&store, 0, true, 30);
+
+    ASSERT_EQ( store.changed_at[0], 10u );
+    ASSERT_EQ( store.changed_at[99], 10u );
+    ASSERT_EQ( store.changed_at[100], 20u );
+    ASSERT_EQ( LedStore_CountChangedSince(&store, 0, LEDS, 15, 30), 50u );
+    ASSERT_EQ( LedStore_CountChangedSince(&store, 0, LEDS, 10, 30), 150u );
+}
+
+//TEST_F(LedStore_Operation, "3. Change times may wrap")
+TEST_F(LedStore_Operation, 3ChangeTimesMayWrap)
+{
+    LedStore_SetRange(&store, 0, 10, true, 0xFFFFFFF0u);
+    LedStore_SetRange(&store, 10, 10, true, 0x00000010u);
+
+    ASSERT_EQ( LedStore_CountChangedSince(&store, 0, 20, 0xFFFFFFE0u, 0x00000020u), 20u );
+    ASSERT_EQ( LedStore_CountChangedSince(&store, 0, 20, 0x00000000u, 0x00000020u), 10u );
+}
+
+//TEST_F(LedStore_Operation, "4. Lit and faulted LEDs can be counted and listed in a range")
+TEST_F(LedStore_Operation, 4LitFaultedLEDsAreFound)
+{
+    uint32_t found[4];
+
+    LedStore_SetRange(&store, 0, 500, true, 0);
+
+    LedStore_SetFault(&store, 3, true);
+    LedStore_SetFault(&store, 64, true);
+    LedStore_SetFault(&store, 200, true);
+    LedStore_SetFault(&store, 700, true);
+    LedStore_SetFault(&store, 499, true);
+    LedStore_SetFault(&store, 499, false);
+
+    ASSERT_EQ( LedStore_CountLitFaulted(&store, 0, LEDS), 3u );
+    ASSERT_EQ( LedStore_CountLitFaulted(&store, 4, 197), 2u );
+
+    ASSERT_EQ( LedStore_FindLitFaulted(&store, 0, LEDS, found, 4), 3u );
+    ASSERT_EQ( found[0], 3u );
+    ASSERT_EQ( found[1], 64u );
+    ASSERT_EQ( found[2], 200u );
+
+    ASSERT_EQ( LedStore_FindLitFaulted(&store, 10, LEDS, found, 1), 1u );
+    ASSERT_EQ( found[0], 64u );
+}
+
+//TEST_F(LedStore_Operation, "5. Metadata columns can be queried by range")
+TEST_F(LedStore_Operation, 5MetadataColumnsAreQueried)
+{
+    for (uint32_t i = 0; i < LEDS; i++)
+    {
+        LedStore_SetBrightness(&store, i, (uint8_t)(i % 256));
+        LedStore_SetOwner(&store, i, (uint16_t)(i % 3));
+    }
+
+    ASSERT_EQ( LedStore_CountBrightnessAtLeast(&store, 0, 256, 200), 56u );
+    ASSERT_EQ( LedStore_CountBrightnessAtLeast(&store, 250, 10, 255), 1u );
+    ASSERT_EQ( LedStore_CountOwnedBy(&store, 0, LEDS, 2), 333u );
+    ASSERT_EQ( LedStore_CountOwnedBy(&store, 1, 3, 0), 1u );
+}
+
+//TEST_F(LedStore_Operation, "6. Bad indices, ranges and storage are refused")
+TEST_F(LedStore_Operation, 6BadArgumentsAreRefused)
+{
+    LedStore other;
+    uint32_t found[1];
+
+    ASSERT_EQ( LedStore_Set(&store, LEDS, true, 0), -1 );
+    ASSERT_EQ( LedStore_SetRange(&store, 900, 101, true, 0), -1 );
+    ASSERT_EQ( LedStore_SetFault(&store, LEDS, true), -1 );
+    ASSERT_EQ( LedStore_SetBrightness(&store, LEDS, 1), -1 );
+    ASSERT_EQ( LedStore_SetOwner(&store, LEDS, 1), -1 );
+    ASSERT_FALSE( LedStore_IsOn(&store, LEDS) );
+
+    ASSERT_EQ( LedStore_CountOn(&store, 5000, 10), 0u );
+    ASSERT_EQ( LedStore_FindLitFaulted(&store, 5000, 10, found, 1), 0u );
+    ASSERT_EQ( LedStore_CountOn(NULL, 0, 10), 0u );
+
+    ASSERT_EQ( LedStore_Init(&other, memory, LedStore_Size(LEDS) - 1, LEDS), -1 );
+    ASSERT_EQ( LedStore_Init(&other, (uint8_t*)memory + 8, LedStore_Size(LEDS), LEDS / 2), -1 );
+}
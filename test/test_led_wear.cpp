@@ -0,0 +1,320 @@
+#include <gtest/gtest.h>
+#include "LedWear.h"
+#include "LedPool.h"
+#include "stdint.h"
+#include "string.h"
+
+extern "C"
+{
+    #include "RuntimeErrorStub.h"
+}
+
+/***********************************************************************
+ * LED Wear Test
+ *
+ * Requirements:
+ * 1. Attached counters start at zero from the bank's current state
+ * 2. Turning an LED on and off adds one toggle each way and its on-time
+ * 3. Writes that change nothing cost no toggles
+ * 4. Counters follow LED numbers through the map, polarity included
+ * 5. Export includes the time LEDs still lit have been on
+ * 6. Sync folds running on-time in without changing the totals
+ * 7. Re-initialising the bank detaches the counters
+ * 8. Export covers many banks in LED order
+ * 9. The tick counter may wrap
+ * 10. Counters without a clock read zero time
+ * 11. Releasing a pool bank detaches its counters with on-time folded in
+ * 12. Detached counters stop accruing
+ *
+************************************************************************/
+
+class LedWear_Operation : public ::testing::Test
+{
+    protected:
+        LedDriver_Bank bank;
+        LedWear_Counters counters;
+        uint16_t LEDs;
+        volatile uint32_t ticks;
+        uint64_t onTime[LED_WEAR_OUTPUTS];
+        uint32_t toggles[LED_WEAR_OUTPUTS];
+
+        virtual void SetUp()
+        {
+            RuntimeErrorStub_Reset();
+
+            ticks = 1000;
+
+            LedDriver_BankInit(&bank, &LEDs, false, false);
+            ASSERT_EQ( LedWear_Attach(&counters, &bank, &ticks), 0 );
+        }
+
+        virtual void TearDown()
+        {
+            // tear down code
+        }
+
+        void exportOne()
+        {
+            ASSERT_EQ( LedWear_Export(&counters, 1, onTime, toggles), 0 );
+        }
+};
+
+//TEST_F(LedWear_Operation, "1. Attached counters start at zero from the bank's current state")
+TEST_F(LedWear_Operation, 1CountersStartAtZero)
+{
+    exportOne();
+
+    for (int i = 0; i < LED_WEAR_OUTPUTS; i++)
+    {
+        ASSERT_EQ( onTime[i], 0u );
+        ASSERT_EQ( toggles[i], 0u );
+    }
+
+    ASSERT_EQ( bank.wear, &counters );
+}
+
+//TEST_F(LedWear_Operation, "2. Turning an LED on and off adds one toggle each way and its on-time")
+TEST_F(LedWear_Operation, 2OnOffAddsTogglesAndOnTime)
+{
+    LedDriver_BankTurnOn(&bank, 3);
+    ticks = 1250;
+    LedDriver_BankTurnOff(&bank, 3);
+    ticks = 2000;
+    LedDriver_BankTurnOn(&bank, 3);
+    ticks = 2100;
+    LedDriver_BankTurnOff(&bank, 3);
+
+    exportOne();
+
+    ASSERT_EQ( onTime[2], 350u );
+    ASSERT_EQ( toggles[2], 4u );
+    ASSERT_EQ( toggles[0], 0u );
+}
+
+//TEST_F(LedWear_Operation, "3. Writes that change nothing cost no toggles")
+TEST_F(LedWear_Operation, 3UnchangedWritesCostNothing)
+{
+    LedDriver_BankTurnOn(&bank, 1);
+    LedDriver_BankTurnOn(&bank, 1);
+    LedDriver_BankUpdate(&bank, 0x0001, 0x0000);
+    LedDriver_BankTurnOff(&bank, 2);
+
+    exportOne();
+
+    ASSERT_EQ( toggles[0], 1u );
+    ASSERT_EQ( toggles[1], 0u );
+}
+
+//TEST_F(LedWear_Operation, "4. Counters follow LED numbers through the map, polarity included")
+TEST_F(LedWear_Operation, 4CountersFollowLedNumbers)
+{
+    LedDriver_Map map;
+    uint8_t physicalBits[16];
+
+    for (int i = 0; i < 16; i++)
+    {
+        physicalBits[i] = (uint8_t)(15 - i);
+    }
+
+    ASSERT_EQ( LedDriver_MapInit(&map, physicalBits), 0 );
+
+    LedDriver_BankInitMapped(&bank, &LEDs, true, &map);
+    ASSERT_EQ( LedWear_Attach(&counters, &bank, &ticks), 0 );
+
+    // Active low: the register bit clears while LED 1 (bit 15) is lit
+    LedDriver_BankTurnOn(&bank, 1);
+    ticks = 1040;
+    LedDriver_BankTurnOffAll(&bank);
+
+    exportOne();
+
+    ASSERT_EQ( LEDs, 0xFFFF );
+    ASSERT_EQ( onTime[0], 40u );
+    ASSERT_EQ( toggles[0], 2u );
+    ASSERT_EQ( toggles[15], 0u );
+}
+
+//TEST_F(LedWear_Operation, "5. Export includes the time LEDs still lit have been on")
+TEST_F(LedWear_Operation, 5ExportIncludesRunningOnTime)
+{
+    LedDriver_BankTurnOnAll(&bank);
+    ticks = 1500;
+
+    exportOne();
+
+    ASSERT_EQ( onTime[0], 500u );
+    ASSERT_EQ( onTime[15], 500u );
+    ASSERT_EQ( toggles[15], 1u );
+
+    ticks = 1700;
+
+    exportOne();
+
+    ASSERT_EQ( onTime[7], 700u );
+}
+
+//TEST_F(LedWear_Operation, "6. Sync folds running on-time in without changing the totals")
+TEST_F(LedWear_Operation, 6SyncKeepsTotals)
+{
+    LedDriver_BankTurnOn(&bank, 5);
+    ticks = 1300;
+    LedWear_Sync(&counters);
+
+    ASSERT_EQ( counters.on_time[4], 300u );
+
+    ticks = 1400;
+    LedDriver_BankTurnOff(&bank, 5);
+
+    exportOne();
+
+    ASSERT_EQ( onTime[4], 400u );
+    ASSERT_EQ( toggles[4], 2u );
+}
+
+//TEST_F(LedWear_Operation, "7. Re-initialising the bank detaches the counters")
+TEST_F(LedWear_Operation, 7ReinitialisingDetaches)
+{
+    LedDriver_BankTurnOn(&bank, 1);
+    LedDriver_BankInit(&bank, &LEDs, false, false);
+
+    ASSERT_EQ( bank.wear, nullptr );
+
+    LedDriver_BankTurnOn(&bank, 2);
+
+    ASSERT_EQ( LedWear_Attach(&counters, &bank, &ticks), 0 );
+    ASSERT_EQ( LedWear_Detach(&bank), 0 );
+    ASSERT_EQ( LedWear_Detach(&bank), -1 );
+
+    LedDriver_BankTurnOn(&bank, 3);
+
+    exportOne();
+
+    ASSERT_EQ( toggles[1], 0u );
+    ASSERT_EQ( toggles[2], 0u );
+}
+
+//TEST_F(LedWear_Operation, "8. Export covers many banks in LED order")
+TEST_F(LedWear_Operation, 8ExportCoversManyBanks)
+{
+    const int banks = 100;
+    LedDriver_Bank many[banks];
+    LedWear_Counters manyCounters[banks];
+    uint16_t registers[banks];
+    uint64_t manyOnTime[banks * LED_WEAR_OUTPUTS];
+    uint32_t manyToggles[banks * LED_WEAR_OUTPUTS];
+
+    for (int i = 0; i < banks; i++)
+    {
+        LedDriver_BankInit(&many[i], &registers[i], false, false);
+        LedWear_Attach(&manyCounters[i], &many[i], &ticks);
+        LedDriver_BankTurnOn(&many[i], (int16_t)((i % 16) + 1));
+    }
+
+    ticks = 1010;
+
+    ASSERT_EQ( LedWear_Export(manyCounters, banks, manyOnTime, manyToggles), 0 );
+
+    for (int i = 0; i < banks; i++)
+    {
+        for (int output = 0; output < LED_WEAR_OUTPUTS; output++)
+        {
+            bool lit = (output == (i % 16));
+
+            ASSERT_EQ( manyOnTime[(i * LED_WEAR_OUTPUTS) + output], lit ? 10u : 0u );
+            ASSERT_EQ( manyToggles[(i * LED_WEAR_OUTPUTS) + output], lit ? 1u : 0u );
+        }
+    }
+
+    ASSERT_EQ( LedWear_Export(NULL, banks, manyOnTime, NULL), -1 );
+    ASSERT_EQ( LedWear_Export(manyCounters, banks, NULL, manyToggles), 0 );
+}
+
+//TEST_F(LedWear_Operation, "9. The tick counter may wrap")
+TEST_F(LedWear_Operation, 9TicksMayWrap)
+{
+    ticks = 0xFFFFFF00u;
+    LedDriver_BankTurnOn(&bank, 16);
+    ticks = 0x00000100u;
+    LedDriver_BankTurnOff(&bank, 16);
+
+    exportOne();
+
+    ASSERT_EQ( onTime[15], 0x200u );
+}
+
+//TEST_F(LedWear_Operation, "10. Counters without a clock read zero time")
+TEST_F(LedWear_Operation, 10NoClockReadsZeroTime)
+{
+    LedWear_Counters unattached;
+
+    // As a calloc'd block of counters that was never attached
+    memset(&unattached, 0, sizeof(unattached));
+
+    LedWear_Sync(&unattached);
+    ASSERT_EQ( LedWear_Export(&unattached, 1, onTime, toggles), 0 );
+    ASSERT_EQ( onTime[0], 0u );
+    ASSERT_EQ( toggles[0], 0u );
+
+    // Toggles are still counted if such a block ends up on a bank
+    bank.wear = &unattached;
+    LedDriver_BankTurnOn(&bank, 1);
+    LedWear_Sync(&unattached);
+    ASSERT_EQ( LedWear_Export(&unattached, 1, onTime, toggles), 0 );
+    ASSERT_EQ( onTime[0], 0u );
+    ASSERT_EQ( toggles[0], 1u );
+
+    bank.wear = NULL;
+}
+
+//TEST_F(LedWear_Operation, "11. Releasing a pool bank detaches its counters with on-time folded in")
+TEST_F(LedWear_Operation, 11PoolReleaseFoldsOnTime)
+{
+    LedDriver_Bank* pooled;
+
+    LedPool_Init();
+    pooled = LedPool_Acquire(&LEDs, false, false);
+
+    ASSERT_NE( pooled, nullptr );
+    ASSERT_EQ( LedWear_Attach(&counters, pooled, &ticks), 0 );
+
+    LedDriver_BankTurnOn(pooled, 3);
+    ticks = 1250;
+
+    ASSERT_EQ( LedPool_Release(pooled), 0 );
+    ASSERT_EQ( counters.on_time[2], 250u );
+
+    // The next owner starts without them
+    pooled = LedPool_Acquire(&LEDs, false, false);
+
+    ASSERT_EQ( pooled->wear, nullptr );
+    ASSERT_EQ( LedPool_Release(pooled), 0 );
+}
+
+//TEST_F(LedWear_Operation, "12. Detached counters stop accruing")
+TEST_F(LedWear_Operation, 12DetachedCountersStop)
+{
+    LedDriver_BankTurnOn(&bank, 1);
+    ticks = 1100;
+
+    ASSERT_EQ( LedWear_Detach(&bank), 0 );
+
+    ticks = 100000;
+    LedWear_Sync(&counters);
+    exportOne();
+
+    ASSERT_EQ( onTime[0], 100u );
+    ASSERT_EQ( toggles[0], 1u );
+
+    // Re-initialising cannot fold the running time in, but stops it all the same
+    ASSERT_EQ( LedWear_Attach(&counters, &bank, &ticks), 0 );
+    LedDriver_BankTurnOn(&bank, 2);
+    ticks = 100200;
+    LedWear_Sync(&counters);
+    ticks = 100300;
+    LedDriver_BankInit(&bank, &LEDs, false, false);
+    ticks = 200000;
+    LedWear_Sync(&counters);
+    exportOne();
+
+    ASSERT_EQ( onTime[1], 200u );
+}